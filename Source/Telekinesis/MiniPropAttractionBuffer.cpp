@@ -0,0 +1,141 @@
+#include "MiniPropAttractionBuffer.h"
+#include "MiniTelekineticActor.h"
+
+void FMiniPropAttractionBuffer::Init(int32 InCapacity)
+{
+	Capacity = FMath::Max(InCapacity, 0);
+	MiniProps.Empty(Capacity);
+	Meshes.Empty(Capacity);
+	Bodies.Empty(Capacity);
+	Strengths.Empty(Capacity);
+	X.Empty(Capacity);
+	Y.Empty(Capacity);
+	Z.Empty(Capacity);
+}
+
+bool FMiniPropAttractionBuffer::Add(AMiniTelekineticActor* MiniProp)
+{
+	if (MiniProps.Num() >= Capacity || MiniProps.Contains(MiniProp))
+	{
+		return false;
+	}
+	UStaticMeshComponent* Mesh = MiniProp->GetMesh();
+	MiniProps.Add(MiniProp);
+	Meshes.Add(Mesh);
+	Bodies.Add(Mesh->GetBodyInstance());
+	Strengths.Add(MiniProp->GetAttractionForce());
+	X.AddUninitialized();
+	Y.AddUninitialized();
+	Z.AddUninitialized();
+	return true;
+}
+
+bool FMiniPropAttractionBuffer::Remove(AMiniTelekineticActor* MiniProp)
+{
+	const int32 Index = MiniProps.Find(MiniProp);
+	if (Index == INDEX_NONE)
+	{
+		return false;
+	}
+	RemoveAt(Index);
+	return true;
+}
+
+void FMiniPropAttractionBuffer::RemoveAt(int32 Index)
+{
+	MiniProps.RemoveAtSwap(Index, 1, false);
+	Meshes.RemoveAtSwap(Index, 1, false);
+	Bodies.RemoveAtSwap(Index, 1, false);
+	Strengths.RemoveAtSwap(Index, 1, false);
+	X.RemoveAtSwap(Index, 1, false);
+	Y.RemoveAtSwap(Index, 1, false);
+	Z.RemoveAtSwap(Index, 1, false);
+}
+
+void FMiniPropAttractionBuffer::Reset()
+{
+	MiniProps.Reset();
+	Meshes.Reset();
+	Bodies.Reset();
+	Strengths.Reset();
+	X.Reset();
+	Y.Reset();
+	Z.Reset();
+}
+
+void FMiniPropAttractionBuffer::RemoveStale()
+{
+	// Backwards, so swapping the last mini prop in doesn't skip it
+	for (int32 Index = MiniProps.Num() - 1; Index >= 0; --Index)
+	{
+		if (!MiniProps[Index].IsValid())
+		{
+			RemoveAt(Index);
+		}
+	}
+}
+
+int32 FMiniPropAttractionBuffer::Num() const
+{
+	return MiniProps.Num();
+}
+
+AMiniTelekineticActor* FMiniPropAttractionBuffer::GetMiniProp(int32 Index) const
+{
+	return MiniProps[Index].Get();
+}
+
+FBodyInstance* FMiniPropAttractionBuffer::GetBody(int32 Index) const
+{
+	return MiniProps[Index].IsValid() ? Bodies[Index] : nullptr;
+}
+
+float FMiniPropAttractionBuffer::GetStrength(int32 Index) const
+{
+	return Strengths[Index];
+}
+
+void FMiniPropAttractionBuffer::Attract(const FVector& Center, float StrengthScale)
+{
+	RemoveStale();
+	const int32 Count = MiniProps.Num();
+	float* RESTRICT PX = X.GetData();
+	float* RESTRICT PY = Y.GetData();
+	float* RESTRICT PZ = Z.GetData();
+	const float* RESTRICT PStrength = Strengths.GetData();
+
+	// Gather positions
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const FVector Location = Meshes[Index]->GetComponentLocation();
+		PX[Index] = Location.X;
+		PY[Index] = Location.Y;
+		PZ[Index] = Location.Z;
+	}
+
+	// Direction to the center times strength, in place and branch free so it vectorizes
+	const float CX = Center.X;
+	const float CY = Center.Y;
+	const float CZ = Center.Z;
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const float DX = CX - PX[Index];
+		const float DY = CY - PY[Index];
+		const float DZ = CZ - PZ[Index];
+		const float SizeSquared = DX * DX + DY * DY + DZ * DZ;
+		// Same cutoff as GetSafeNormal, mini props sitting on the center get no force
+		const float Scale = SizeSquared > SMALL_NUMBER ? PStrength[Index] * StrengthScale * FMath::InvSqrt(SizeSquared) : 0.f;
+		PX[Index] = DX * Scale;
+		PY[Index] = DY * Scale;
+		PZ[Index] = DZ * Scale;
+	}
+
+	// Apply the forces as accelerations, like AMiniTelekineticActor::AttractForce
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		if (Bodies[Index]->IsValidBodyInstance())
+		{
+			Bodies[Index]->AddForce(FVector(PX[Index], PY[Index], PZ[Index]), true, true);
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Fixed capacity, structure of arrays set of AMiniTelekineticActors being attracted to a held prop.
+ * Storage is allocated once in Init, Attract() then does the force math for every mini prop in one pass.
+ */
+class TELEKINESIS_API FMiniPropAttractionBuffer
+{
+public:
+	/** Allocate room for Capacity mini props, nothing is allocated after this */
+	void Init(int32 InCapacity);
+	/** Returns false if the mini prop is already attracted or we're full */
+	bool Add(class AMiniTelekineticActor* MiniProp);
+	/** Only uses MiniProp as a key, so it's safe to call for mini props that are being destroyed */
+	bool Remove(AMiniTelekineticActor* MiniProp);
+	void Reset();
+	/** Drop every mini prop that has been destroyed since it was added */
+	void RemoveStale();
+
+	int32 Num() const;
+	/** Null if the mini prop has been destroyed */
+	AMiniTelekineticActor* GetMiniProp(int32 Index) const;
+	/** Null if the mini prop has been destroyed */
+	struct FBodyInstance* GetBody(int32 Index) const;
+	float GetStrength(int32 Index) const;
+
+	/** Apply every mini prop's attraction force towards Center, scaled by StrengthScale, after dropping destroyed ones */
+	void Attract(const FVector& Center, float StrengthScale = 1.f);
+
+private:
+	int32 Capacity = 0;
+	/** Weak, so a mini prop destroyed without telling us can't leave its mesh and body dangling */
+	TArray<TWeakObjectPtr<AMiniTelekineticActor>> MiniProps;
+	TArray<class UStaticMeshComponent*> Meshes;
+	TArray<struct FBodyInstance*> Bodies;
+	/** Attraction acceleration of each mini prop */
+	TArray<float> Strengths;
+	/** Positions in, forces out */
+	TArray<float> X;
+	TArray<float> Y;
+	TArray<float> Z;
+
+	void RemoveAt(int32 Index);
+
+};
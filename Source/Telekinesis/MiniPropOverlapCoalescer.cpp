@@ -0,0 +1,46 @@
+#include "MiniPropOverlapCoalescer.h"
+
+bool FMiniPropOverlapCoalescer::BeginOverlap(AMiniTelekineticActor* MiniProp)
+{
+	return AddEvent(MiniProp, true);
+}
+
+bool FMiniPropOverlapCoalescer::EndOverlap(AMiniTelekineticActor* MiniProp)
+{
+	return AddEvent(MiniProp, false);
+}
+
+bool FMiniPropOverlapCoalescer::HasPendingEvents() const
+{
+	return PendingMiniProps.Num() > 0;
+}
+
+void FMiniPropOverlapCoalescer::Reset()
+{
+	PendingMiniProps.Reset();
+	PendingOverlapping.Reset();
+	PendingIndices.Reset();
+}
+
+void FMiniPropOverlapCoalescer::Flush(TFunctionRef<void(AMiniTelekineticActor* MiniProp, bool bOverlapping)> Apply)
+{
+	for (int32 Index = 0; Index < PendingMiniProps.Num(); ++Index)
+	{
+		Apply(PendingMiniProps[Index], PendingOverlapping[Index]);
+	}
+	Reset();
+}
+
+bool FMiniPropOverlapCoalescer::AddEvent(AMiniTelekineticActor* MiniProp, bool bOverlapping)
+{
+	// The last event for a mini prop this frame wins
+	if (const int32* Index = PendingIndices.Find(MiniProp))
+	{
+		PendingOverlapping[*Index] = bOverlapping;
+		return false;
+	}
+	const bool bFirstEvent = PendingMiniProps.Num() == 0;
+	PendingIndices.Add(MiniProp, PendingMiniProps.Add(MiniProp));
+	PendingOverlapping.Add(bOverlapping);
+	return bFirstEvent;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Collects a frame's worth of AttractionField begin/end overlaps with AMiniTelekineticActors,
+ * so each mini prop gets at most one attraction change per frame no matter how often it flickers in and out.
+ */
+class TELEKINESIS_API FMiniPropOverlapCoalescer
+{
+public:
+	/** Returns true if this is the first event since the last Flush */
+	bool BeginOverlap(class AMiniTelekineticActor* MiniProp);
+	/** Returns true if this is the first event since the last Flush */
+	bool EndOverlap(AMiniTelekineticActor* MiniProp);
+	bool HasPendingEvents() const;
+	void Reset();
+
+	/** Calls Apply once per mini prop with whether it ended up overlapping, then clears our events */
+	void Flush(TFunctionRef<void(AMiniTelekineticActor* MiniProp, bool bOverlapping)> Apply);
+
+private:
+	TArray<AMiniTelekineticActor*> PendingMiniProps;
+	TArray<bool> PendingOverlapping;
+	/** Where each pending mini prop is in the arrays above, so a frame full of flickering overlaps doesn't search them */
+	TMap<AMiniTelekineticActor*, int32> PendingIndices;
+
+	bool AddEvent(AMiniTelekineticActor* MiniProp, bool bOverlapping);
+
+};
@@ -0,0 +1,301 @@
+#include "MiniPropSwarmComponent.h"
+#include "MiniTelekineticActor.h"
+#include "TelekinesisWorldSubsystem.h"
+#include "Engine/World.h"
+
+UMiniPropSwarmComponent::UMiniPropSwarmComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	SetMobility(EComponentMobility::Movable);
+	// Instances never collide, anything that needs to is promoted first
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetGenerateOverlapEvents(false);
+}
+
+void UMiniPropSwarmComponent::BeginPlay()
+{
+	Super::BeginPlay();
+	if (PromotedClass != nullptr)
+	{
+		AttractionForce = PromotedClass->GetDefaultObject<AMiniTelekineticActor>()->GetAttractionForce();
+	}
+
+	const int32 NumInstances = GetInstanceCount();
+	PX.Reserve(NumInstances);
+	PY.Reserve(NumInstances);
+	PZ.Reserve(NumInstances);
+	VX.Reserve(NumInstances);
+	VY.Reserve(NumInstances);
+	VZ.Reserve(NumInstances);
+	GroundZ.Reserve(NumInstances);
+	Awake.Reserve(NumInstances);
+	Promoted.Reserve(NumInstances);
+	InstanceTransforms.Reserve(NumInstances);
+	RenderTransforms.Reserve(NumInstances);
+	for (int32 Index = 0; Index < NumInstances; ++Index)
+	{
+		FTransform Transform;
+		GetInstanceTransform(Index, Transform, true);
+		AddParticle(Transform);
+	}
+}
+
+int32 UMiniPropSwarmComponent::AddMiniProp(const FTransform& WorldTransform)
+{
+	const int32 Index = AddInstance(WorldTransform, true);
+	// Before BeginPlay we'll pick the instance up with the rest
+	if (HasBegunPlay())
+	{
+		AddParticle(WorldTransform);
+	}
+	return Index;
+}
+
+void UMiniPropSwarmComponent::AddParticle(const FTransform& WorldTransform)
+{
+	const FVector Location = WorldTransform.GetLocation();
+	PX.Add(Location.X);
+	PY.Add(Location.Y);
+	PZ.Add(Location.Z);
+	VX.Add(0.f);
+	VY.Add(0.f);
+	VZ.Add(0.f);
+	GroundZ.Add(Location.Z);
+	Awake.Add(false);
+	Promoted.Add(false);
+	InstanceTransforms.Add(WorldTransform);
+	RenderTransforms.Add(WorldTransform);
+}
+
+void UMiniPropSwarmComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (const UTelekinesisWorldSubsystem* TelekinesisSubsystem = GetWorld()->GetSubsystem<UTelekinesisWorldSubsystem>())
+	{
+		TelekinesisSubsystem->GetMiniPropAttractors(Attractors);
+	}
+	else
+	{
+		Attractors.Reset();
+	}
+
+	Integrate(DeltaTime);
+
+	// Hand the closest particles over to real mini props, a few per frame
+	if (PromotedClass != nullptr)
+	{
+		const int32 NumPromotions = FMath::Min3(PromotionCandidates.Num(), MaxPromotionsPerFrame, MaxPromoted - PromotedActors.Num());
+		if (NumPromotions > 0)
+		{
+			// Only pop as many as we promote off the heap, there can be far more candidates than that
+			const auto IsCloser = [](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; };
+			PromotionCandidates.Heapify(IsCloser);
+			for (int32 Candidate = 0; Candidate < NumPromotions; ++Candidate)
+			{
+				TPair<float, int32> Closest;
+				PromotionCandidates.HeapPop(Closest, IsCloser, false);
+				Promote(Closest.Value);
+			}
+		}
+	}
+	UpdateDemotions();
+	FlushInstanceTransforms();
+}
+
+void UMiniPropSwarmComponent::Integrate(float DeltaTime)
+{
+	PromotionCandidates.Reset();
+	if (DeltaTime <= 0.f)
+	{
+		return;
+	}
+	const float GravityZ = GetWorld()->GetGravityZ();
+	// Exact decay over the frame, so particles slow down the same however the frame is sliced
+	const float AttractedDamping = FMath::Exp(-AttractedLinearDamping * DeltaTime);
+	const float ReleasedDamping = FMath::Exp(-ReleasedLinearDamping * DeltaTime);
+	const float PromoteDistanceSquared = FMath::Square(PromoteDistance);
+	const float SleepSpeedSquared = FMath::Square(SleepSpeed);
+
+	const int32 Count = PX.Num();
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		if (Promoted[Index])
+		{
+			continue;
+		}
+
+		// Attraction, same force as FMiniPropAttractionBuffer::Attract and no gravity while attracted
+		float AX = 0.f;
+		float AY = 0.f;
+		float AZ = 0.f;
+		bool bAttracted = false;
+		float ClosestDistanceSquared = PromoteDistanceSquared;
+		for (const FSphere& Attractor : Attractors)
+		{
+			const float DX = Attractor.Center.X - PX[Index];
+			const float DY = Attractor.Center.Y - PY[Index];
+			const float DZ = Attractor.Center.Z - PZ[Index];
+			const float DistanceSquared = DX * DX + DY * DY + DZ * DZ;
+			if (DistanceSquared > FMath::Square(Attractor.W) || DistanceSquared <= SMALL_NUMBER)
+			{
+				continue;
+			}
+			const float Scale = AttractionForce * FMath::InvSqrt(DistanceSquared);
+			AX += DX * Scale;
+			AY += DY * Scale;
+			AZ += DZ * Scale;
+			bAttracted = true;
+			ClosestDistanceSquared = FMath::Min(ClosestDistanceSquared, DistanceSquared);
+		}
+		if (ClosestDistanceSquared < PromoteDistanceSquared)
+		{
+			PromotionCandidates.Emplace(ClosestDistanceSquared, Index);
+		}
+		if (bAttracted)
+		{
+			Awake[Index] = true;
+		}
+		else
+		{
+			AZ = GravityZ;
+		}
+		if (!Awake[Index])
+		{
+			continue;
+		}
+
+		// Semi-implicit Euler, damped as much over DeltaTime as a mini prop body with the same linear damping
+		const float Damping = bAttracted ? AttractedDamping : ReleasedDamping;
+		VX[Index] = (VX[Index] + AX * DeltaTime) * Damping;
+		VY[Index] = (VY[Index] + AY * DeltaTime) * Damping;
+		VZ[Index] = (VZ[Index] + AZ * DeltaTime) * Damping;
+		PX[Index] += VX[Index] * DeltaTime;
+		PY[Index] += VY[Index] * DeltaTime;
+		PZ[Index] += VZ[Index] * DeltaTime;
+
+		// Land back on the height we were placed at, and go to sleep once we've stopped
+		if (PZ[Index] < GroundZ[Index])
+		{
+			PZ[Index] = GroundZ[Index];
+			if (VZ[Index] < 0.f)
+			{
+				VZ[Index] *= -GroundBounciness;
+				VX[Index] *= 1.f - GroundFriction;
+				VY[Index] *= 1.f - GroundFriction;
+			}
+			if (!bAttracted && VX[Index] * VX[Index] + VY[Index] * VY[Index] + VZ[Index] * VZ[Index] < SleepSpeedSquared)
+			{
+				VX[Index] = 0.f;
+				VY[Index] = 0.f;
+				VZ[Index] = 0.f;
+				Awake[Index] = false;
+			}
+		}
+
+		SetInstanceLocation(Index, FVector(PX[Index], PY[Index], PZ[Index]), true);
+	}
+}
+
+void UMiniPropSwarmComponent::Promote(int32 Index)
+{
+	const FVector Location(PX[Index], PY[Index], PZ[Index]);
+	FTransform Transform = InstanceTransforms[Index];
+	Transform.SetLocation(Location);
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AMiniTelekineticActor* MiniProp = GetWorld()->SpawnActor<AMiniTelekineticActor>(PromotedClass, Transform, SpawnParameters);
+	if (MiniProp == nullptr)
+	{
+		return;
+	}
+	// Carry on where the particle left off, the held prop's AttractionField takes it from here
+	MiniProp->GetMesh()->SetPhysicsLinearVelocity(FVector(VX[Index], VY[Index], VZ[Index]));
+	Promoted[Index] = true;
+	Awake[Index] = false;
+	SetInstanceLocation(Index, Location, false);
+	PromotedActors.Add(MiniProp);
+	PromotedInstances.Add(Index);
+}
+
+void UMiniPropSwarmComponent::UpdateDemotions()
+{
+	const int32 NumChecks = FMath::Min(MaxDemotionChecksPerFrame, PromotedActors.Num());
+	for (int32 Check = 0; Check < NumChecks && PromotedActors.Num() > 0; ++Check)
+	{
+		const int32 PromotedIndex = NextDemotionCheck % PromotedActors.Num();
+		const AMiniTelekineticActor* MiniProp = PromotedActors[PromotedIndex];
+		// Something else destroyed it, its instance stays hidden
+		if (!IsValid(MiniProp))
+		{
+			PromotedActors.RemoveAtSwap(PromotedIndex, 1, false);
+			PromotedInstances.RemoveAtSwap(PromotedIndex, 1, false);
+			continue;
+		}
+		// Only demote mini props at rest and out of reach of every held prop
+		bool bDemote = !MiniProp->GetMesh()->IsAnyRigidBodyAwake();
+		const FVector Location = MiniProp->GetActorLocation();
+		for (int32 Attractor = 0; bDemote && Attractor < Attractors.Num(); ++Attractor)
+		{
+			bDemote = FVector::DistSquared(Location, Attractors[Attractor].Center) > FMath::Square(Attractors[Attractor].W + PromoteDistance);
+		}
+		if (bDemote)
+		{
+			Demote(PromotedIndex);
+		}
+		else
+		{
+			++NextDemotionCheck;
+		}
+	}
+}
+
+void UMiniPropSwarmComponent::Demote(int32 PromotedIndex)
+{
+	AMiniTelekineticActor* MiniProp = PromotedActors[PromotedIndex];
+	const int32 Index = PromotedInstances[PromotedIndex];
+	const FVector Location = MiniProp->GetActorLocation();
+	InstanceTransforms[Index].SetRotation(MiniProp->GetActorQuat());
+	PX[Index] = Location.X;
+	PY[Index] = Location.Y;
+	PZ[Index] = Location.Z;
+	VX[Index] = 0.f;
+	VY[Index] = 0.f;
+	VZ[Index] = 0.f;
+	// Wherever it came to rest is the ground now
+	GroundZ[Index] = Location.Z;
+	Awake[Index] = false;
+	Promoted[Index] = false;
+	SetInstanceLocation(Index, Location, true);
+	MiniProp->Destroy();
+	PromotedActors.RemoveAtSwap(PromotedIndex, 1, false);
+	PromotedInstances.RemoveAtSwap(PromotedIndex, 1, false);
+}
+
+void UMiniPropSwarmComponent::SetInstanceLocation(int32 Index, const FVector& Location, bool bVisible)
+{
+	FTransform& Transform = RenderTransforms[Index];
+	Transform = InstanceTransforms[Index];
+	Transform.SetLocation(Location);
+	// Hidden instances keep their slot so particle and instance indices always match
+	if (!bVisible)
+	{
+		Transform.SetScale3D(FVector::ZeroVector);
+	}
+	FirstDirtyInstance = FMath::Min(FirstDirtyInstance, Index);
+	LastDirtyInstance = FMath::Max(LastDirtyInstance, Index);
+}
+
+void UMiniPropSwarmComponent::FlushInstanceTransforms()
+{
+	if (LastDirtyInstance < FirstDirtyInstance)
+	{
+		return;
+	}
+	// Instances in the range that didn't move are resent unchanged, that's still far cheaper than one update per instance
+	DirtyTransforms.Reset(LastDirtyInstance - FirstDirtyInstance + 1);
+	DirtyTransforms.Append(RenderTransforms.GetData() + FirstDirtyInstance, LastDirtyInstance - FirstDirtyInstance + 1);
+	BatchUpdateInstancesTransforms(FirstDirtyInstance, DirtyTransforms, true, true, true);
+	FirstDirtyInstance = MAX_int32;
+	LastDirtyInstance = INDEX_NONE;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "MiniPropSwarmComponent.generated.h"
+
+/**
+ * Lots of mini props drawn as instances and moved by a cheap particle integrator instead of one actor each.
+ * Every instance we move in a frame is sent to the renderer in one batch. Plain instances rather than a hierarchical
+ * component, since moving instances would rebuild its cluster tree every frame.
+ * Held props attract the particles like they attract AMiniTelekineticActors, and particles that get close to a held
+ * prop are promoted to a real AMiniTelekineticActor so they can collide and be captured by its AttractionField.
+ * Promoted mini props that come to rest away from any held prop are demoted back to instances.
+ */
+UCLASS(ClassGroup=(Telekinesis), meta=(BlueprintSpawnableComponent))
+class TELEKINESIS_API UMiniPropSwarmComponent : public UInstancedStaticMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+	UMiniPropSwarmComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Add a mini prop to the swarm at runtime, instances placed in the editor are picked up in BeginPlay */
+	int32 AddMiniProp(const FTransform& WorldTransform);
+
+	int32 GetNumMiniProps() const { return PX.Num(); }
+	int32 GetNumPromoted() const { return PromotedActors.Num(); }
+
+	/** What particles are promoted to, also the attraction settings they copy */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Swarm")
+	TSubclassOf<class AMiniTelekineticActor> PromotedClass;
+	/** Particles closer than this to a held prop become a real mini prop */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Swarm")
+	float PromoteDistance = 150.f;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Swarm", meta=(ClampMin=0))
+	int32 MaxPromotionsPerFrame = 8;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Swarm", meta=(ClampMin=0))
+	int32 MaxPromoted = 256;
+	/** How many promoted mini props we check for demotion each frame */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Swarm", meta=(ClampMin=0))
+	int32 MaxDemotionChecksPerFrame = 16;
+	/** Linear damping of attracted and free particles, same as ATelekineticActor gives its mini props */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Swarm")
+	float AttractedLinearDamping = 10.f;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Swarm")
+	float ReleasedLinearDamping = 0.01f;
+	/** Particles land on the height they were placed at, keeping this much of their speed */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Swarm", meta=(ClampMin=0, ClampMax=1))
+	float GroundBounciness = 0.3f;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Swarm", meta=(ClampMin=0, ClampMax=1))
+	float GroundFriction = 0.5f;
+	/** Particles on the ground slower than this stop simulating */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Swarm")
+	float SleepSpeed = 5.f;
+
+protected:
+	virtual void BeginPlay() override;
+
+private:
+	// Particles, one per instance and in the same order
+	TArray<float> PX;
+	TArray<float> PY;
+	TArray<float> PZ;
+	TArray<float> VX;
+	TArray<float> VY;
+	TArray<float> VZ;
+	/** Height we were placed at, we treat it as the ground */
+	TArray<float> GroundZ;
+	TArray<bool> Awake;
+	TArray<bool> Promoted;
+	/** Rotation and scale of each instance, the integrator only moves them */
+	TArray<FTransform> InstanceTransforms;
+	/** What each instance is drawn with, and the range of them changed since we last sent them to the renderer */
+	TArray<FTransform> RenderTransforms;
+	int32 FirstDirtyInstance = MAX_int32;
+	int32 LastDirtyInstance = INDEX_NONE;
+	/** Scratch for the dirty range */
+	TArray<FTransform> DirtyTransforms;
+	float AttractionForce = 1000.f;
+
+	UPROPERTY()
+	TArray<AMiniTelekineticActor*> PromotedActors;
+	TArray<int32> PromotedInstances;
+	int32 NextDemotionCheck = 0;
+
+	/** Scratch, held props as (center, attraction radius) and this frame's promotion candidates as (distance squared, instance) */
+	TArray<FSphere> Attractors;
+	TArray<TPair<float, int32>> PromotionCandidates;
+
+	void AddParticle(const FTransform& WorldTransform);
+	void Integrate(float DeltaTime);
+	void Promote(int32 Index);
+	void UpdateDemotions();
+	void Demote(int32 PromotedIndex);
+	void SetInstanceLocation(int32 Index, const FVector& Location, bool bVisible);
+	/** Send every instance moved this frame to the renderer in one batch */
+	void FlushInstanceTransforms();
+
+};
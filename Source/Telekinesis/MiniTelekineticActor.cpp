@@ -23,3 +23,31 @@ TObjectPtr<UStaticMeshComponent> AMiniTelekineticActor::GetMesh() const
 {
 	return TelekineticMesh;
 }
+
+float AMiniTelekineticActor::GetAttractionForce() const
+{
+	return AttractionForce;
+}
+
+void AMiniTelekineticActor::BeginAttraction()
+{
+	if (NumAttractors++ == 0)
+	{
+		TelekineticMesh->SetEnableGravity(false);
+		TelekineticMesh->SetLinearDamping(10.f);
+	}
+}
+
+void AMiniTelekineticActor::EndAttraction()
+{
+	if (NumAttractors > 0 && --NumAttractors == 0)
+	{
+		TelekineticMesh->SetEnableGravity(true);
+		TelekineticMesh->SetLinearDamping(0.01f);
+	}
+}
+
+int32 AMiniTelekineticActor::GetNumAttractors() const
+{
+	return NumAttractors;
+}
@@ -13,6 +13,12 @@ public:
 	AMiniTelekineticActor();
 	void AttractForce(const FVector& Direction) const;
 	TObjectPtr<UStaticMeshComponent> GetMesh() const;
+	float GetAttractionForce() const;
+	/** A prop started attracting us, the first one turns our gravity off and damps us so we settle around it */
+	void BeginAttraction();
+	/** A prop stopped attracting us, we only fall again once none of the props that attracted us still do */
+	void EndAttraction();
+	int32 GetNumAttractors() const;
 
 protected:
 	virtual void BeginPlay() override;
@@ -23,5 +29,8 @@ private:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Attraction", meta=(AllowPrivateAccess = "true"))
 	float AttractionForce = 1000.f;
+
+	/** How many props are attracting us, held props can overlap each other's attraction fields */
+	int32 NumAttractors = 0;
 	
 };
@@ -8,7 +8,7 @@ public class Telekinesis : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay", "Niagara" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay", "Niagara", "Chaos", "PhysicsCore", "GeometryCollectionEngine", "FieldSystemEngine", "MassEntity", "MassCommon", "SignificanceManager", "Json", "JsonUtilities" });
 
 	}
 }
@@ -3,5 +3,7 @@
 #include "Telekinesis.h"
 #include "Modules/ModuleManager.h"
 
+DEFINE_LOG_CATEGORY(LogTelekinesis);
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Telekinesis, "Telekinesis" );
  
\ No newline at end of file
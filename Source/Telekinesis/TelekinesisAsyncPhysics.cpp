@@ -0,0 +1,105 @@
+#include "TelekinesisAsyncPhysics.h"
+#include "TelekinesisReachKernel.h"
+#include "TelekinesisWorldSubsystem.h"
+#include "PhysicsProxy/SingleParticlePhysicsProxy.h"
+
+void FTelekinesisSimCallback::OnPreSimulate_Internal()
+{
+	// No new input just means the game thread hasn't ticked since our last step, keep running the last one
+	if (const FTelekinesisAsyncInput* Input = GetConsumerInput_Internal())
+	{
+		ConsumeInput(*Input);
+	}
+	const float DeltaTime = GetDeltaTime_Internal();
+	if (DeltaTime <= 0.f)
+	{
+		return;
+	}
+	for (FInternalProp& Prop : InternalProps)
+	{
+		StepProp(Prop, DeltaTime);
+	}
+}
+
+void FTelekinesisSimCallback::ConsumeInput(const FTelekinesisAsyncInput& Input)
+{
+	PreviousProps.Reset();
+	for (const FInternalProp& Prop : InternalProps)
+	{
+		PreviousProps.Add(Prop.Input.Proxy, Prop);
+	}
+
+	InternalProps.Reset();
+	for (const FTelekinesisAsyncProp& PropInput : Input.Props)
+	{
+		FInternalProp& Prop = InternalProps.AddDefaulted_GetRef();
+		if (const FInternalProp* PreviousProp = PreviousProps.Find(PropInput.Proxy))
+		{
+			// We run ahead of the game thread, so don't let its Lift progress pull us backwards
+			Prop = *PreviousProp;
+			Prop.LiftAlpha = FMath::Max(PreviousProp->LiftAlpha, PropInput.LiftAlpha);
+		}
+		else
+		{
+			Prop.LiftAlpha = PropInput.LiftAlpha;
+			Prop.JitterRandom.Initialize(PropInput.JitterSeed);
+			Prop.JitterIntervalSeconds = Prop.JitterRandom.RandRange(PropInput.JitterFrameTimeMin, PropInput.JitterFrameTimeMax) * UTelekinesisWorldSubsystem::ReachTimeStep;
+		}
+		Prop.Input = PropInput;
+	}
+	InternalMiniProps = Input.MiniProps;
+}
+
+void FTelekinesisSimCallback::StepProp(FInternalProp& Prop, float DeltaTime)
+{
+	const FTelekinesisAsyncProp& Input = Prop.Input;
+	Chaos::FRigidBodyHandle_Internal* Body = Input.Proxy != nullptr ? Input.Proxy->GetPhysicsThreadAPI() : nullptr;
+	if (Body == nullptr || Body->ObjectState() != Chaos::EObjectStateType::Dynamic)
+	{
+		return;
+	}
+	const FVector Location = Body->X();
+	FVector Velocity = Body->V();
+
+	// Lift, move up towards our target height
+	if (Input.bLift)
+	{
+		Prop.LiftAlpha = FMath::Min(Prop.LiftAlpha + Input.LiftAlphaPerSecond * DeltaTime, 1.f);
+		Body->SetX(FVector(Location.X, Location.Y, FTelekinesisReachKernel::GetLiftHeight(Location.Z, Input.LiftTargetZ, Prop.LiftAlpha)));
+	}
+
+	// Reach, the impulse is a velocity change per ReachTimeStep so spread it over our step
+	if (Input.bReach)
+	{
+		const float Scale = Input.MassMultiplier * Input.SpeedMultiplier * DeltaTime / UTelekinesisWorldSubsystem::ReachTimeStep;
+		Velocity += FTelekinesisReachKernel::GetImpulse(Location, Input.Target, Scale, Input.bConstantSpeed);
+
+		if (Input.bJitter)
+		{
+			Prop.JitterElapsedSeconds += DeltaTime;
+			if (Prop.JitterElapsedSeconds >= Prop.JitterIntervalSeconds)
+			{
+				Prop.JitterElapsedSeconds = 0.f;
+				Prop.JitterIntervalSeconds = Prop.JitterRandom.RandRange(Input.JitterFrameTimeMin, Input.JitterFrameTimeMax) * UTelekinesisWorldSubsystem::ReachTimeStep;
+				const int32 Strength = Prop.JitterRandom.RandRange(FMath::TruncToInt(Input.JitterStrengthMin), FMath::TruncToInt(Input.JitterStrengthMax));
+				Velocity += Prop.JitterRandom.GetUnitVector() * Strength;
+			}
+		}
+
+		Velocity *= FTelekinesisReachKernel::GetDampingScale(Input.LinearDamping, DeltaTime);
+		Body->SetV(Velocity);
+	}
+
+	// Attract our mini props, as accelerations like FMiniPropAttractionBuffer::Attract
+	for (int32 Index = Input.FirstMiniProp; Index < Input.FirstMiniProp + Input.NumMiniProps; ++Index)
+	{
+		const FTelekinesisAsyncMiniProp& MiniProp = InternalMiniProps[Index];
+		Chaos::FRigidBodyHandle_Internal* MiniBody = MiniProp.Proxy != nullptr ? MiniProp.Proxy->GetPhysicsThreadAPI() : nullptr;
+		if (MiniBody == nullptr || MiniBody->ObjectState() != Chaos::EObjectStateType::Dynamic)
+		{
+			continue;
+		}
+		const FVector Direction = (Location - FVector(MiniBody->X())).GetSafeNormal();
+		MiniBody->SetV(MiniBody->V() + Direction * (MiniProp.Strength * DeltaTime));
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Chaos/SimCallbackInput.h"
+#include "Chaos/SimCallbackObject.h"
+#include "Physics/PhysicsInterfaceDeclares.h"
+
+/** One prop's force model, posted by the game thread every frame for the physics thread to run */
+struct FTelekinesisAsyncProp
+{
+	Chaos::FSingleParticlePhysicsProxy* Proxy = nullptr;
+
+	// Reach, same model as ATelekineticActor::GetReachImpulse
+	bool bReach = false;
+	FVector Target = FVector::ZeroVector;
+	float SpeedMultiplier = 1.f;
+	float MassMultiplier = 1.f;
+	bool bConstantSpeed = false;
+	float LinearDamping = 0.f;
+
+	// Lift, the physics thread carries Alpha on from where the game thread last saw it
+	bool bLift = false;
+	float LiftTargetZ = 0.f;
+	float LiftAlpha = 0.f;
+	float LiftAlphaPerSecond = 0.f;
+
+	// Jitter, only while held
+	bool bJitter = false;
+	int32 JitterFrameTimeMin = 0;
+	int32 JitterFrameTimeMax = 0;
+	float JitterStrengthMin = 0.f;
+	float JitterStrengthMax = 0.f;
+	int32 JitterSeed = 0;
+
+	/** Our attracted mini props are FTelekinesisAsyncInput::MiniProps[FirstMiniProp, FirstMiniProp + NumMiniProps) */
+	int32 FirstMiniProp = 0;
+	int32 NumMiniProps = 0;
+};
+
+/** A mini prop attracted to an FTelekinesisAsyncProp */
+struct FTelekinesisAsyncMiniProp
+{
+	Chaos::FSingleParticlePhysicsProxy* Proxy = nullptr;
+	/** Attraction acceleration */
+	float Strength = 0.f;
+};
+
+struct FTelekinesisAsyncInput : public Chaos::FSimCallbackInput
+{
+	TArray<FTelekinesisAsyncProp> Props;
+	TArray<FTelekinesisAsyncMiniProp> MiniProps;
+
+	void Reset()
+	{
+		Props.Reset();
+		MiniProps.Reset();
+	}
+};
+
+/**
+ * Runs the telekinesis force model inside the Chaos solver, once per physics step.
+ * The game thread only posts targets and state through FTelekinesisAsyncInput, every velocity change happens here.
+ */
+class FTelekinesisSimCallback : public Chaos::TSimCallbackObject<FTelekinesisAsyncInput>
+{
+private:
+	/** Physics thread copy of a prop, with the state that has to survive between inputs */
+	struct FInternalProp
+	{
+		FTelekinesisAsyncProp Input;
+		float LiftAlpha = 0.f;
+		float JitterElapsedSeconds = 0.f;
+		float JitterIntervalSeconds = 0.f;
+		FRandomStream JitterRandom;
+	};
+
+	// Physics thread only
+	TArray<FInternalProp> InternalProps;
+	TArray<FTelekinesisAsyncMiniProp> InternalMiniProps;
+	TMap<Chaos::FSingleParticlePhysicsProxy*, FInternalProp> PreviousProps;
+
+	virtual void OnPreSimulate_Internal() override;
+
+	/** Take on a new input, keeping the Lift and Jitter progress of props we already had */
+	void ConsumeInput(const FTelekinesisAsyncInput& Input);
+	void StepProp(FInternalProp& Prop, float DeltaTime);
+
+};
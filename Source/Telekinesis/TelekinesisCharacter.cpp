@@ -1,16 +1,23 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "TelekinesisCharacter.h"
+#include "Telekinesis.h"
 
 #include "TelekineticActor.h"
+#include "TelekinesisReplaySubsystem.h"
+#include "TelekinesisStats.h"
+#include "TelekinesisWorldSubsystem.h"
+#include "TelekineticPropEntitySubsystem.h"
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
 #include "Components/InputComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/Controller.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "Net/UnrealNetwork.h"
 
 //////////////////////////////////////////////////////////////////////////
 // ATelekinesisCharacter
@@ -57,10 +64,30 @@ ATelekinesisCharacter::ATelekinesisCharacter()
 	PropSceneComponent = CreateDefaultSubobject<USceneComponent>(TEXT("PropSceneComponent"));
 	PropSceneComponent->SetupAttachment(GetMesh());
 
+	// Create the trajectory preview, its instances are placed in world space
+	TrajectoryPreview = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("TrajectoryPreview"));
+	TrajectoryPreview->SetupAttachment(RootComponent);
+	TrajectoryPreview->SetUsingAbsoluteLocation(true);
+	TrajectoryPreview->SetUsingAbsoluteRotation(true);
+	TrajectoryPreview->SetUsingAbsoluteScale(true);
+	TrajectoryPreview->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	TrajectoryPreview->SetCastShadow(false);
+	TrajectoryPreview->SetVisibility(false);
+
+	// Only look for telekinesis objects
+	TargetObjectTypes.Add(ObjectTypeQuery7);
+
 	// Note: The skeletal mesh and anim blueprint references on the Mesh component (inherited from Character) 
 	// are set in the derived blueprint asset named ThirdPersonCharacter (to avoid direct content references in C++)
 }
 
+void ATelekinesisCharacter::BeginPlay()
+{
+	Super::BeginPlay();
+	HighlightManager.HysteresisSeconds = HighlightHysteresisSeconds;
+	HighlightManager.ScoreMargin = HighlightScoreMargin;
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Input
 
@@ -82,62 +109,253 @@ void ATelekinesisCharacter::SetupPlayerInputComponent(class UInputComponent* Pla
 	PlayerInputComponent->BindAxis("Look Up / Down Mouse", this, &APawn::AddControllerPitchInput);
 }
 
+void ATelekinesisCharacter::Jump()
+{
+	if (UTelekinesisReplaySubsystem* ReplaySubsystem = GetWorld()->GetSubsystem<UTelekinesisReplaySubsystem>())
+	{
+		ReplaySubsystem->RecordInput(this, ETelekinesisReplayInput::Jump);
+	}
+	Super::Jump();
+}
+
+void ATelekinesisCharacter::StopJumping()
+{
+	if (UTelekinesisReplaySubsystem* ReplaySubsystem = GetWorld()->GetSubsystem<UTelekinesisReplaySubsystem>())
+	{
+		ReplaySubsystem->RecordInput(this, ETelekinesisReplayInput::StopJumping);
+	}
+	Super::StopJumping();
+}
+
 void ATelekinesisCharacter::Tick(float DeltaSeconds)
 {
 	Super::Tick(DeltaSeconds);
 
-	// Don't perform line trace if we're holding an object
-	if (CurrTelekineticProp != nullptr)
+	SolveHoldSlots();
+	UpdateVolley(DeltaSeconds);
+
+	// Determine trace start location, offset by the detection radius so trace doesn't start behind the camera
+	const FVector StartLocation = FollowCamera->GetComponentLocation() + (FollowCamera->GetForwardVector() * DetectionRadius);
+	// Determine trace end location
+	const FVector EndLocation = FollowCamera->GetComponentLocation() + (FollowCamera->GetForwardVector() * TelekinesisDistance);
+	if (bAsyncTraces)
+	{
+		UpdateAsyncTraces(StartLocation, EndLocation);
+	}
+	UpdateTrajectoryPreview();
+
+	// Only the player aiming looks for targets, and not if we can't hold any more objects
+	if (!IsLocallyControlled() || !CanHoldMoreProps())
 	{
 		return;
 	}
 
-	// Only look for telekinesis objects
-	TArray<TEnumAsByte<EObjectTypeQuery>> ObjectTypes;
-	ObjectTypes.Add(ObjectTypeQuery7);
+	// Only score targets every TargetScoringInterval frames, unless we've stopped aiming at our target
+	++FramesSinceTargetScoring;
+	const ATelekineticActor* CurrentTarget = HighlightManager.GetTarget();
+	if (FramesSinceTargetScoring >= TargetScoringInterval || (CurrentTarget != nullptr && !IsAimingAt(CurrentTarget, StartLocation, EndLocation)))
+	{
+		FramesSinceTargetScoring = 0;
+
+		// Find the prop we're aiming at
+		float HitDistance = 0.f;
+		ATelekineticActor* TKProp = bUsePropGrid
+			? FindTargetInPropGrid(StartLocation, EndLocation, HitDistance)
+			: FindTargetWithTrace(StartLocation, EndLocation, HitDistance);
+		if (bUsePropGrid && bValidateTargetAcquisition)
+		{
+			float TracedDistance = 0.f;
+			const ATelekineticActor* TracedProp = FindTargetWithTrace(StartLocation, EndLocation, TracedDistance);
+			if (TracedProp != TKProp)
+			{
+				UE_LOG(LogTelekinesis, Warning, TEXT("Prop grid picked %s but the sphere trace picked %s"), *GetNameSafe(TKProp), *GetNameSafe(TracedProp));
+			}
+		}
+		AcquireTargetEntity(StartLocation, EndLocation, TKProp != nullptr ? HitDistance : TNumericLimits<float>::Max());
 
-	// Determine trace start location, offset by the detection radius so trace doesn't start behind the camera
-	FVector StartLocation = FollowCamera->GetComponentLocation() + (FollowCamera->GetForwardVector() * DetectionRadius);
-	// Determine trace end location
-	FVector EndLocation = FollowCamera->GetComponentLocation() + (FollowCamera->GetForwardVector() * TelekinesisDistance);
+		// Closer props score higher
+		const float Score = TKProp != nullptr ? 1.f - (HitDistance / TelekinesisDistance) : 0.f;
+		HighlightManager.Update(TKProp, Score, DeltaSeconds);
+	}
+	else
+	{
+		HighlightManager.KeepTarget(DeltaSeconds);
+	}
+
+	// Cache our target and apply any highlight change, once per frame
+	TelekineticTarget = HighlightManager.GetTarget();
+	HighlightManager.Flush();
+}
+
+ATelekineticActor* ATelekinesisCharacter::FindTargetInPropGrid(const FVector& StartLocation, const FVector& EndLocation, float& OutDistance)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TelekinesisTargetTrace);
+	UTelekinesisWorldSubsystem* TelekinesisSubsystem = GetWorld()->GetSubsystem<UTelekinesisWorldSubsystem>();
+	if (TelekinesisSubsystem == nullptr)
+	{
+		return nullptr;
+	}
+
+	// Bounds vs the exact capsule our sphere sweeps, so every prop the trace could hit is a candidate and few others are
+	const FVector Delta = EndLocation - StartLocation;
+	const FVector Direction = Delta.GetSafeNormal();
+	TelekinesisSubsystem->GetPropGrid().QueryCone(StartLocation, Direction, 0.f, Delta.Size(), DetectionRadius, 0.f, TargetCandidates);
+
+	// Precise sweep against the candidates, closest first, until nothing left can beat our closest hit
+	ATelekineticActor* ClosestProp = nullptr;
+	float ClosestDistance = TNumericLimits<float>::Max();
+	const FCollisionShape Sphere = FCollisionShape::MakeSphere(DetectionRadius);
+	for (const FTelekineticPropCandidate& Candidate : TargetCandidates)
+	{
+		// Candidates are sorted, nothing after this one can be closer than what we've hit
+		if (Candidate.Distance - DetectionRadius > ClosestDistance)
+		{
+			break;
+		}
+		if (TargetActorsToIgnore.Contains(Candidate.Prop))
+		{
+			continue;
+		}
+		FHitResult Hit;
+		TelekinesisSubsystem->CountTraces();
+		if (Candidate.Prop->GetMesh()->SweepComponent(Hit, StartLocation, EndLocation, FQuat::Identity, Sphere) && Hit.Distance < ClosestDistance)
+		{
+			ClosestDistance = Hit.Distance;
+			ClosestProp = Candidate.Prop;
+		}
+	}
+	OutDistance = ClosestDistance;
+	return ClosestProp;
+}
+
+void ATelekinesisCharacter::AcquireTargetEntity(const FVector& StartLocation, const FVector& EndLocation, float ActorDistance)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TelekinesisTargetTrace);
+	UTelekineticPropEntitySubsystem* EntitySubsystem = GetWorld()->GetSubsystem<UTelekineticPropEntitySubsystem>();
+	if (EntitySubsystem == nullptr || EntitySubsystem->GetNumEntities() == 0)
+	{
+		return;
+	}
+	// Entities are swept off the game thread, so we act on the sweep we posted last time
+	float EntityDistance = 0.f;
+	const FMassEntityHandle Entity = EntitySubsystem->GetTargetResult(this, EntityDistance);
+	if (Entity.IsSet() && EntityDistance < ActorDistance)
+	{
+		EntitySubsystem->RequestPromotion(Entity);
+		// Score again next frame, when its actor is in the prop grid
+		FramesSinceTargetScoring = TargetScoringInterval;
+	}
+	EntitySubsystem->QueryTarget(this, StartLocation, EndLocation, DetectionRadius);
+}
 
-	// Perform the trace
+ATelekineticActor* ATelekinesisCharacter::FindTargetWithTrace(const FVector& StartLocation, const FVector& EndLocation, float& OutDistance)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TelekinesisTargetTrace);
+	// Last frame's sweep, see UpdateAsyncTraces
+	if (bAsyncTraces)
+	{
+		OutDistance = AsyncTargetDistance;
+		return AsyncTarget.Get();
+	}
+	if (UTelekinesisWorldSubsystem* TelekinesisSubsystem = GetWorld()->GetSubsystem<UTelekinesisWorldSubsystem>())
+	{
+		TelekinesisSubsystem->CountTraces();
+	}
 	FHitResult Hit;
-	TArray<AActor*> ActorsToIgnore;
 	UKismetSystemLibrary::SphereTraceSingleForObjects(
 		GetWorld(),
 		StartLocation,
 		EndLocation,
 		DetectionRadius,
-		ObjectTypes,
+		TargetObjectTypes,
 		false,
-		ActorsToIgnore,
+		TargetActorsToIgnore,
 		EDrawDebugTrace::None,
 		Hit,
 		true
 	);
+	OutDistance = Hit.Distance;
+	return Cast<ATelekineticActor>(Hit.GetActor());
+}
 
-	// Check if we hit something
-	if (Hit.GetActor() != nullptr)
+bool ATelekinesisCharacter::IsAimingAt(const ATelekineticActor* Prop, const FVector& StartLocation, const FVector& EndLocation) const
+{
+	// Cheap ray vs bounding sphere check, no scene query
+	const FBoxSphereBounds& Bounds = Prop->GetMesh()->Bounds;
+	const FVector Delta = EndLocation - StartLocation;
+	const float Length = Delta.Size();
+	const FVector Direction = Delta.GetSafeNormal();
+	const FVector ToCenter = Bounds.Origin - StartLocation;
+	const float Along = FMath::Clamp(FVector::DotProduct(ToCenter, Direction), 0.f, Length);
+	return (ToCenter - Direction * Along).SizeSquared() <= FMath::Square(Bounds.SphereRadius + DetectionRadius);
+}
+
+void ATelekinesisCharacter::UpdateAsyncTraces(const FVector& StartLocation, const FVector& EndLocation)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TelekinesisTargetTrace);
+	UTelekinesisWorldSubsystem* TelekinesisSubsystem = GetWorld()->GetSubsystem<UTelekinesisWorldSubsystem>();
+	if (TelekinesisSubsystem == nullptr)
 	{
-		ATelekineticActor* TKProp = Cast<ATelekineticActor>(Hit.GetActor());
-		// Remove the highlight from any past TelekineticActor
-		if (TelekineticTarget != nullptr)
-		{
-			TelekineticTarget->Highlight(false);
-		}
-		// Highlight and cache the new TelekineticActor
-		TelekineticTarget = TKProp;
-		TelekineticTarget->Highlight(true);
+		return;
 	}
-	// Didn't hit anything, remove any active TelekineticActor
-	else if (TelekineticTarget != nullptr)
+
+	// Pick up whatever finished since last frame
+	FHitResult Hit;
+	if (TelekinesisSubsystem->GetAsyncTraceResult(TargetTraceHandle, Hit))
+	{
+		AsyncTarget = Cast<ATelekineticActor>(Hit.GetActor());
+		AsyncTargetDistance = Hit.Distance;
+	}
+	TargetTraceHandle.Invalidate();
+	bPushTraceResultValid = TelekinesisSubsystem->GetAsyncTraceResult(PushTraceHandle, Hit);
+	if (bPushTraceResultValid)
+	{
+		// The result belongs to the camera we requested it from
+		PushTraceImpactPoint = Hit.ImpactPoint;
+		PushTraceStart = PendingPushTraceStart;
+		PushTraceDirection = PendingPushTraceDirection;
+	}
+	PushTraceHandle.Invalidate();
+
+	// Target sweep, only needed when we don't use the prop grid or we're validating it
+	if (IsLocallyControlled() && CanHoldMoreProps() && (!bUsePropGrid || bValidateTargetAcquisition))
+	{
+		FCollisionQueryParams Params(SCENE_QUERY_STAT(TelekinesisTarget), false, this);
+		Params.AddIgnoredActors(TargetActorsToIgnore);
+		TargetTraceHandle = TelekinesisSubsystem->AsyncSweepByObjectType(StartLocation, EndLocation,
+			FCollisionShape::MakeSphere(DetectionRadius), FCollisionObjectQueryParams(TargetObjectTypes), Params);
+	}
+	else
+	{
+		AsyncTarget.Reset();
+	}
+
+	// Aim trace, so a Push next frame doesn't have to trace at all
+	if (bTelekinesis || bVolleyActive)
 	{
-		TelekineticTarget->Highlight(false);
-		TelekineticTarget = nullptr;
+		TArray<AActor*> ActorsToIgnore;
+		GetPushTraceIgnoredActors(ActorsToIgnore);
+		FCollisionQueryParams Params(SCENE_QUERY_STAT(TelekinesisPush), false);
+		Params.AddIgnoredActors(ActorsToIgnore);
+		PendingPushTraceStart = FollowCamera->GetComponentLocation();
+		PendingPushTraceDirection = FollowCamera->GetForwardVector();
+		PushTraceHandle = TelekinesisSubsystem->AsyncLineTraceByChannel(PendingPushTraceStart,
+			PendingPushTraceStart + PendingPushTraceDirection * PushTraceDistance, ECC_Visibility, Params);
 	}
 }
 
+bool ATelekinesisCharacter::CanReusePushTrace() const
+{
+	if (!bAsyncTraces || !bPushTraceResultValid)
+	{
+		return false;
+	}
+	const FVector CameraLocation = FollowCamera->GetComponentLocation();
+	const FVector CameraDirection = FollowCamera->GetForwardVector();
+	return FVector::DistSquared(CameraLocation, PushTraceStart) <= FMath::Square(PushTraceReuseDistance)
+		&& FVector::DotProduct(CameraDirection, PushTraceDirection) >= FMath::Cos(FMath::DegreesToRadians(PushTraceReuseAngle));
+}
+
 void ATelekinesisCharacter::TurnRight(float Rate)
 {
 	AddControllerYawInput(Rate);
@@ -153,6 +371,10 @@ void ATelekinesisCharacter::TurnRight(float Rate)
 
 void ATelekinesisCharacter::MoveForward(float Value)
 {
+	if (UTelekinesisReplaySubsystem* ReplaySubsystem = GetWorld()->GetSubsystem<UTelekinesisReplaySubsystem>())
+	{
+		ReplaySubsystem->RecordAxis(this, ETelekinesisReplayAxis::MoveForward, Value);
+	}
 	if ((Controller != nullptr) && (Value != 0.0f))
 	{
 		// find out which way is forward
@@ -167,6 +389,10 @@ void ATelekinesisCharacter::MoveForward(float Value)
 
 void ATelekinesisCharacter::MoveRight(float Value)
 {
+	if (UTelekinesisReplaySubsystem* ReplaySubsystem = GetWorld()->GetSubsystem<UTelekinesisReplaySubsystem>())
+	{
+		ReplaySubsystem->RecordAxis(this, ETelekinesisReplayAxis::MoveRight, Value);
+	}
 	if ((Controller != nullptr) && (Value != 0.0f))
 	{
 		// find out which way is right
@@ -182,34 +408,112 @@ void ATelekinesisCharacter::MoveRight(float Value)
 
 void ATelekinesisCharacter::InputTelekinesis()
 {
-	// Pull or Push depending on our current state
-	if (!bTelekinesis && TelekineticTarget != nullptr)
+	if (UTelekinesisReplaySubsystem* ReplaySubsystem = GetWorld()->GetSubsystem<UTelekinesisReplaySubsystem>())
+	{
+		ReplaySubsystem->RecordInput(this, ETelekinesisReplayInput::Telekinesis);
+	}
+	// Wait for a volley to finish before doing anything else
+	if (bVolleyActive)
+	{
+		return;
+	}
+	// Pull or Push depending on our current state, with multi hold we keep pulling until we're full.
+	// Clients don't wait for the server, they predict and get corrected
+	if (TelekineticTarget != nullptr && CanHoldMoreProps())
 	{
+		if (!HasAuthority())
+		{
+			ServerPull(TelekineticTarget);
+		}
 		Pull();
 	}
 	else if (bTelekinesis)
+	{
+		if (!HasAuthority())
+		{
+			ServerPush();
+		}
+		Push();
+	}
+}
+
+void ATelekinesisCharacter::ServerPull_Implementation(ATelekineticActor* Prop)
+{
+	const bool bInRange = Prop != nullptr
+		&& FVector::DistSquared(GetActorLocation(), Prop->GetActorLocation()) <= FMath::Square(TelekinesisDistance + PullDistanceTolerance);
+	if (bVolleyActive || !bInRange || !CanHoldMoreProps() || HeldProps.Contains(Prop) || !Prop->CanBePulledBy(this))
+	{
+		UE_LOG(LogTelekinesis, Verbose, TEXT("%s rejected Pull of %s"), *GetName(), *GetNameSafe(Prop));
+		ClientRejectPull(Prop);
+		return;
+	}
+	TelekineticTarget = Prop;
+	Pull();
+}
+
+void ATelekinesisCharacter::ServerPush_Implementation()
+{
+	if (bTelekinesis && !bVolleyActive)
 	{
 		Push();
 	}
 }
 
+void ATelekinesisCharacter::ClientRejectPull_Implementation(ATelekineticActor* Prop)
+{
+	if (Prop == nullptr || !HeldProps.Contains(Prop))
+	{
+		return;
+	}
+	HeldProps.Remove(Prop);
+	TargetActorsToIgnore.Remove(Prop);
+	Prop->Drop();
+	if (HeldProps.Num() == 0)
+	{
+		CurrTelekineticProp = nullptr;
+		ExitTelekinesis();
+	}
+}
+
 void ATelekinesisCharacter::Pull()
 {
-	bTelekinesis = true;
-	GetCharacterMovement()->bOrientRotationToMovement = false;
-	CameraOffsetRightTarget = CameraZoomOffsetRight;
-	CameraOffsetUpTarget = CameraZoomOffsetUp;
-	CameraArmLengthTarget = CameraZoomArmLength;
-	// Call blueprints to handle rotating / zooming in the camera
-	Zoom();
+	// Only zoom in for the first prop we pull
+	if (!bTelekinesis)
+	{
+		bTelekinesis = true;
+		GetCharacterMovement()->bOrientRotationToMovement = false;
+		CameraOffsetRightTarget = CameraZoomOffsetRight;
+		CameraOffsetUpTarget = CameraZoomOffsetUp;
+		CameraArmLengthTarget = CameraZoomArmLength;
+		// Call blueprints to handle rotating / zooming in the camera
+		Zoom();
+	}
 	// Tell prop to lift and pull towards us
 	CurrTelekineticProp = TelekineticTarget;
+	HeldProps.Add(TelekineticTarget);
+	TargetActorsToIgnore.Add(TelekineticTarget);
 	TelekineticTarget->Pull(this);
+	TelekineticTarget->SetHoldSlot(HeldProps.Num() - 1);
+	// The prop drops its own highlight when it's pulled
+	HighlightManager.ForgetTarget();
 	// Play our Pull animation
 	PlayAnimMontage(PullAnimMontage);
 }
 
 void ATelekinesisCharacter::Push()
+{
+	ExitTelekinesis();
+	// Fire our first prop now, any others follow one every VolleyInterval
+	bVolleyActive = true;
+	VolleyCountdown = 0.f;
+	UpdateVolley(0.f);
+	// Kill the reference to our held prop
+	CurrTelekineticProp = nullptr;
+	// Play our Push animation
+	PlayAnimMontage(PushAnimMontage);
+}
+
+void ATelekinesisCharacter::ExitTelekinesis()
 {
 	bTelekinesis = false;
 	bFaceForward = false;
@@ -219,22 +523,25 @@ void ATelekinesisCharacter::Push()
 	CameraArmLengthTarget = CameraDefaultArmLength;
 	// Call blueprints to handle rotating / zooming in the camera
 	Zoom();
-	// Determine push line trace and send to the prop
-	FVector ImpactPoint = FVector::ZeroVector;
-	PushTrace(ImpactPoint);
-	CurrTelekineticProp->Push(ImpactPoint);
-	// Kill the reference to our held prop
-	CurrTelekineticProp = nullptr;
-	// Play our Push animation
-	PlayAnimMontage(PushAnimMontage);
 }
 
 void ATelekinesisCharacter::PushTrace(FVector& ImpactPoint)
 {
+	SCOPE_CYCLE_COUNTER(STAT_TelekinesisTargetTrace);
+	// Our async aim trace from last frame is still good if we've barely moved
+	if (CanReusePushTrace())
+	{
+		ImpactPoint = PushTraceImpactPoint;
+		return;
+	}
+
 	TArray<AActor*> ActorsToIgnore;
-	ActorsToIgnore.Add(this);
-	ActorsToIgnore.Add(CurrTelekineticProp);
+	GetPushTraceIgnoredActors(ActorsToIgnore);
 
+	if (UTelekinesisWorldSubsystem* TelekinesisSubsystem = GetWorld()->GetSubsystem<UTelekinesisWorldSubsystem>())
+	{
+		TelekinesisSubsystem->CountTraces();
+	}
 	FHitResult Hit;
 	const FVector End = FollowCamera->GetComponentLocation() + (FollowCamera->GetForwardVector() * PushTraceDistance);
 	UKismetSystemLibrary::LineTraceSingle(
@@ -252,6 +559,161 @@ void ATelekinesisCharacter::PushTrace(FVector& ImpactPoint)
 	ImpactPoint	= Hit.ImpactPoint;
 }
 
+void ATelekinesisCharacter::GetPushTraceIgnoredActors(TArray<AActor*>& OutActors) const
+{
+	// Don't hit ourselves, anything we're holding or anything we've just thrown
+	OutActors.Reset();
+	OutActors.Add(const_cast<ATelekinesisCharacter*>(this));
+	OutActors.Append(TargetActorsToIgnore);
+	OutActors.Append(VolleyProps);
+}
+
+void ATelekinesisCharacter::UpdateTrajectoryPreview()
+{
+	SCOPE_CYCLE_COUNTER(STAT_TelekinesisTrajectory);
+	UTelekinesisWorldSubsystem* TelekinesisSubsystem = GetWorld()->GetSubsystem<UTelekinesisWorldSubsystem>();
+	// Only the player aiming sees it, and only while they're holding something they could push at a target we've traced
+	if (!bShowTrajectory || TelekinesisSubsystem == nullptr || !IsLocallyControlled() || !bTelekinesis || bVolleyActive
+		|| HeldProps.Num() == 0 || !bPushTraceResultValid || TrajectoryPreview->GetStaticMesh() == nullptr)
+	{
+		HideTrajectoryPreview();
+		return;
+	}
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	// Predict every held prop at once, in the order a volley would fire them
+	const int32 MaxSteps = FMath::Max(FMath::CeilToInt(TrajectorySeconds / UTelekinesisWorldSubsystem::ReachTimeStep), 1);
+	TrajectorySteps = TrajectorySteps > 0 ? FMath::Min(TrajectorySteps, MaxSteps) : MaxSteps;
+	TrajectoryBatch.Reset();
+	// Held props that were destroyed are null until they're dropped, the first one we do have leads the volley
+	const ATelekineticActor* LeadProp = nullptr;
+	for (const ATelekineticActor* Prop : HeldProps)
+	{
+		if (Prop != nullptr)
+		{
+			FVector Location;
+			FVector Velocity;
+			float Scale = 0.f;
+			float DampingScale = 0.f;
+			Prop->GetPushPrediction(Location, Velocity, Scale, DampingScale);
+			TrajectoryBatch.AddLane(Location, Velocity, Scale, DampingScale);
+			LeadProp = LeadProp != nullptr ? LeadProp : Prop;
+		}
+	}
+	if (LeadProp == nullptr)
+	{
+		HideTrajectoryPreview();
+		return;
+	}
+	TrajectoryBatch.Simulate(PushTraceImpactPoint, UTelekinesisWorldSubsystem::ReachTimeStep, TrajectorySteps, TrajectorySampleInterval);
+	UpdateTrajectorySweeps(TelekinesisSubsystem, LeadProp);
+	UpdateTrajectoryInstances();
+	TrajectoryPreview->SetVisibility(true);
+
+	// Stay in budget by predicting less far ahead, and win the distance back once we're well under it
+	const float Microseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.f;
+	if (Microseconds > TrajectoryBudgetMicroseconds)
+	{
+		TrajectorySteps = FMath::Max(TrajectorySteps * 3 / 4, TrajectorySampleInterval);
+	}
+	else if (Microseconds < TrajectoryBudgetMicroseconds * 0.5f)
+	{
+		TrajectorySteps = FMath::Min(TrajectorySteps + FMath::Max(TrajectorySteps / 8, 1), MaxSteps);
+	}
+}
+
+void ATelekinesisCharacter::HideTrajectoryPreview()
+{
+	if (TrajectoryPreview->IsVisible())
+	{
+		TrajectoryPreview->SetVisibility(false);
+	}
+	TrajectorySweepHandles.Reset();
+	TrajectoryHitLength = TNumericLimits<float>::Max();
+}
+
+void ATelekinesisCharacter::UpdateTrajectorySweeps(UTelekinesisWorldSubsystem* TelekinesisSubsystem, const ATelekineticActor* LeadProp)
+{
+	// The first segment that hit is where the first prop stops
+	TrajectoryHitLength = TNumericLimits<float>::Max();
+	for (int32 Index = 0; Index < TrajectorySweepHandles.Num(); ++Index)
+	{
+		FHitResult Hit;
+		if (TelekinesisSubsystem->GetAsyncTraceResult(TrajectorySweepHandles[Index], Hit) && Hit.bBlockingHit)
+		{
+			TrajectoryHitLength = TrajectorySweepStartLengths[Index] + Hit.Distance;
+			break;
+		}
+	}
+	TrajectorySweepHandles.Reset();
+	TrajectorySweepStartLengths.Reset();
+
+	const int32 NumSamples = TrajectoryBatch.GetNumSamples();
+	const int32 NumSegments = FMath::Min(TrajectorySweepSegments, NumSamples - 1);
+	if (NumSegments <= 0)
+	{
+		return;
+	}
+	// Sweep the lead prop's collision along straight segments through its samples, all in flight together
+	const UStaticMeshComponent* PropMesh = LeadProp->GetMesh();
+	const FCollisionShape Sphere = FCollisionShape::MakeSphere(PropMesh->Bounds.BoxExtent.GetMin());
+	TArray<AActor*> ActorsToIgnore;
+	GetPushTraceIgnoredActors(ActorsToIgnore);
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(TelekinesisTrajectory), false);
+	Params.AddIgnoredActors(ActorsToIgnore);
+	const FCollisionResponseParams ResponseParams(PropMesh->GetCollisionResponseToChannels());
+	float Length = 0.f;
+	int32 Sample = 0;
+	for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+	{
+		const int32 EndSample = (Segment + 1) * (NumSamples - 1) / NumSegments;
+		const FVector Start = TrajectoryBatch.GetSample(0, Sample);
+		const FVector End = TrajectoryBatch.GetSample(0, EndSample);
+		TrajectorySweepStartLengths.Add(Length);
+		TrajectorySweepHandles.Add(TelekinesisSubsystem->AsyncSweepByChannel(Start, End, Sphere, PropMesh->GetCollisionObjectType(), Params, ResponseParams));
+		Length += FVector::Dist(Start, End);
+		Sample = EndSample;
+	}
+}
+
+void ATelekinesisCharacter::UpdateTrajectoryInstances()
+{
+	// Enough instances for every sample we could ever draw, unused ones are scaled to nothing
+	const int32 MaxLanes = bMultiHold ? MaxHeldProps : 1;
+	const int32 MaxSamples = FMath::CeilToInt(TrajectorySeconds / UTelekinesisWorldSubsystem::ReachTimeStep) / FMath::Max(TrajectorySampleInterval, 1) + 1;
+	const FTransform Hidden(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+	if (TrajectoryPreview->GetInstanceCount() != MaxLanes * MaxSamples)
+	{
+		TrajectoryPreview->ClearInstances();
+		TrajectoryTransforms.Init(Hidden, MaxLanes * MaxSamples);
+		TrajectoryPreview->AddInstances(TrajectoryTransforms, false);
+	}
+
+	const int32 NumLanes = FMath::Min(TrajectoryBatch.GetNumLanes(), MaxLanes);
+	const int32 NumSamples = FMath::Min(TrajectoryBatch.GetNumSamples(), MaxSamples);
+	for (int32 Lane = 0; Lane < MaxLanes; ++Lane)
+	{
+		float Length = 0.f;
+		for (int32 Sample = 0; Sample < MaxSamples; ++Sample)
+		{
+			FTransform& Transform = TrajectoryTransforms[Lane * MaxSamples + Sample];
+			if (Lane >= NumLanes || Sample >= NumSamples)
+			{
+				Transform = Hidden;
+				continue;
+			}
+			const FVector Location = TrajectoryBatch.GetSample(Lane, Sample);
+			// The first prop's path ends where its sweep hit, the others follow it to the same target
+			if (Lane == 0 && Sample > 0)
+			{
+				Length += FVector::Dist(TrajectoryBatch.GetSample(Lane, Sample - 1), Location);
+			}
+			Transform = Length <= TrajectoryHitLength ? FTransform(FQuat::Identity, Location, TrajectorySampleScale) : Hidden;
+		}
+	}
+	TrajectoryPreview->BatchUpdateInstancesTransforms(0, TrajectoryTransforms, true, true);
+}
+
 void ATelekinesisCharacter::AddCameraBoomOffset() const
 {
 	const FVector Right = UKismetMathLibrary::GetRightVector(GetControlRotation());
@@ -260,7 +722,88 @@ void ATelekinesisCharacter::AddCameraBoomOffset() const
 	CameraBoom->SocketOffset = Offset;
 }
 
+void ATelekinesisCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	// Our own client predicts its HeldProps
+	DOREPLIFETIME_CONDITION(ATelekinesisCharacter, HeldProps, COND_SkipOwner);
+}
+
 FVector ATelekinesisCharacter::GetTelekineticPropLocation() const
 {
 	return PropSceneComponent->GetComponentLocation();
 }
+
+FVector ATelekinesisCharacter::GetTelekineticPropLocation(int32 HoldSlot) const
+{
+	return HoldSlotLocations.IsValidIndex(HoldSlot) ? HoldSlotLocations[HoldSlot] : GetTelekineticPropLocation();
+}
+
+bool ATelekinesisCharacter::CanHoldMoreProps() const
+{
+	return !bVolleyActive && HeldProps.Num() < (bMultiHold ? MaxHeldProps : 1);
+}
+
+void ATelekinesisCharacter::SolveHoldSlots()
+{
+	// A single prop just reaches for the PropSceneComponent
+	const int32 NumSlots = HeldProps.Num();
+	if (NumSlots <= 1)
+	{
+		HoldSlotLocations.Reset();
+		return;
+	}
+
+	// Spread the slots evenly over a disc facing the camera using a golden angle spiral, spinning over time
+	static const float GoldenAngle = PI * (3.f - FMath::Sqrt(5.f));
+	const FVector Center = GetTelekineticPropLocation();
+	const FVector Right = FollowCamera->GetRightVector();
+	const FVector Up = FollowCamera->GetUpVector();
+	const float Spin = FMath::DegreesToRadians(OrbitSpeed * GetWorld()->GetTimeSeconds());
+	HoldSlotLocations.SetNumUninitialized(NumSlots, false);
+	for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+	{
+		const float Radius = OrbitRadius * FMath::Sqrt((Slot + 0.5f) / NumSlots);
+		float Sin, Cos;
+		FMath::SinCos(&Sin, &Cos, Slot * GoldenAngle + Spin);
+		HoldSlotLocations[Slot] = Center + (Right * Cos + Up * Sin) * Radius;
+		// Replicated props may not have resolved yet on other clients
+		if (HeldProps[Slot] != nullptr)
+		{
+			HeldProps[Slot]->SetHoldSlot(Slot);
+		}
+	}
+}
+
+void ATelekinesisCharacter::UpdateVolley(float DeltaSeconds)
+{
+	if (!bVolleyActive)
+	{
+		return;
+	}
+	// Held props destroyed since we started are null now, there's nothing left of them to fire
+	HeldProps.Remove(nullptr);
+	VolleyCountdown -= DeltaSeconds;
+	while (VolleyCountdown <= 0.f && HeldProps.Num() > 0)
+	{
+		FireNextVolleyProp();
+		VolleyCountdown += VolleyInterval;
+	}
+	if (HeldProps.Num() == 0)
+	{
+		bVolleyActive = false;
+		VolleyProps.Reset();
+		TargetActorsToIgnore.Reset();
+	}
+}
+
+void ATelekinesisCharacter::FireNextVolleyProp()
+{
+	// Trace for every prop so a volley follows the crosshair
+	FVector ImpactPoint = FVector::ZeroVector;
+	PushTrace(ImpactPoint);
+	ATelekineticActor* Prop = HeldProps[0];
+	HeldProps.RemoveAt(0);
+	VolleyProps.Add(Prop);
+	Prop->Push(ImpactPoint);
+}
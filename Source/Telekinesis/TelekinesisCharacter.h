@@ -4,12 +4,22 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "TelekinesisHighlightManager.h"
+#include "TelekinesisTrajectory.h"
+#include "TelekineticPropGrid.h"
 #include "TelekinesisCharacter.generated.h"
 
 UCLASS(config=Game)
 class ATelekinesisCharacter : public ACharacter
 {
 	GENERATED_BODY()
+
+	/** Drives our telekinesis input without a player */
+	friend class ATelekinesisStressTest;
+	/** Records and replays our input */
+	friend class UTelekinesisReplaySubsystem;
+	/** Compares our prop grid and sphere trace targeting */
+	friend class FTelekinesisTargetAcquisitionTest;
 	
 public:
 	ATelekinesisCharacter();
@@ -19,6 +29,11 @@ public:
 	float TurnRateGamepad;
 	
 	virtual void Tick(float DeltaSeconds) override;
+
+	// ACharacter interface
+	virtual void Jump() override;
+	virtual void StopJumping() override;
+	// End of ACharacter interface
 	
 	/** Returns CameraBoom sub object **/
 	FORCEINLINE class USpringArmComponent* GetCameraBoom() const { return CameraBoom; }
@@ -27,6 +42,11 @@ public:
 
 	/** Get the location of the PropSceneComponent */
 	FVector GetTelekineticPropLocation() const;
+	float GetTelekinesisDistance() const { return TelekinesisDistance; }
+	/** Get the location a held prop should reach for, its orbit slot when holding several props */
+	FVector GetTelekineticPropLocation(int32 HoldSlot) const;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 protected:
 	UFUNCTION(BlueprintImplementableEvent)
@@ -41,6 +61,8 @@ protected:
 	/** Called for forwards/backward input */
 	void InputTelekinesis();
 
+	virtual void BeginPlay() override;
+
 	// APawn interface
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 	// End of APawn interface
@@ -57,6 +79,10 @@ private:
 	/** Scene Component for held Telekinetic Props */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Telekinesis", meta = (AllowPrivateAccess = "true"))
 	class USceneComponent* PropSceneComponent;
+
+	/** Draws the predicted Push path of our held props, one instance per sample. Give it a small mesh to turn the preview on */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Telekinesis|Trajectory", meta = (AllowPrivateAccess = "true"))
+	class UInstancedStaticMeshComponent* TrajectoryPreview;
 	
 	/** Camera and Camera Boom properties */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Camera", meta=(AllowPrivateAccess=true))
@@ -96,12 +122,73 @@ private:
 	/** Sphere Trace Distance of our Telekinesis  */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Telekinesis", meta=(AllowPrivateAccess=true))
 	float TelekinesisDistance = 5000.f;
+	/** Find targets with the prop grid instead of a sphere trace through the physics scene */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis", meta=(AllowPrivateAccess=true))
+	bool bUsePropGrid = true;
+	/** Also run the sphere trace and log whenever it picks a different target than the prop grid */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis", meta=(AllowPrivateAccess=true, EditCondition="bUsePropGrid"))
+	bool bValidateTargetAcquisition = false;
+	/** Seconds a new target (or losing our target) has to persist before the highlight moves */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis", meta=(AllowPrivateAccess=true))
+	float HighlightHysteresisSeconds = 0.1f;
+	/** A target scoring this much better than the current one takes the highlight immediately */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis", meta=(AllowPrivateAccess=true))
+	float HighlightScoreMargin = 0.25f;
+	/** Only score targets every this many frames, in between we keep our target while we're still aiming at it */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis", meta=(AllowPrivateAccess=true, ClampMin=1))
+	int32 TargetScoringInterval = 1;
+	/** Run our scene queries asynchronously, using each result the frame after it's requested */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis|Async Traces", meta=(AllowPrivateAccess=true))
+	bool bAsyncTraces = true;
+	/** Push uses last frame's aim trace if the camera has moved less than this since it was requested */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis|Async Traces", meta=(AllowPrivateAccess=true, EditCondition="bAsyncTraces"))
+	float PushTraceReuseDistance = 10.f;
+	/** Push uses last frame's aim trace if the camera has turned less than this many degrees since it was requested */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis|Async Traces", meta=(AllowPrivateAccess=true, EditCondition="bAsyncTraces"))
+	float PushTraceReuseAngle = 1.f;
 	/** The Actor we are currently using Telekinesis on  */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Telekinesis", meta=(AllowPrivateAccess=true))
 	class ATelekineticActor* TelekineticTarget = nullptr;
 	/** The Actor we are currently using Telekinesis on  */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Telekinesis", meta=(AllowPrivateAccess=true))
 	class ATelekineticActor* CurrTelekineticProp = nullptr;
+	/** Every prop we're currently holding, in the order they were pulled. Replicated so other clients can solve our hold slots */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Replicated, Category="Telekinesis", meta=(AllowPrivateAccess=true))
+	TArray<class ATelekineticActor*> HeldProps;
+	/** How much further than our TelekinesisDistance the server accepts a Pull from, covers our movement during latency */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis|Network", meta=(AllowPrivateAccess=true))
+	float PullDistanceTolerance = 500.f;
+	/** Keep pulling props until we hold MaxHeldProps, then Push fires them all in a volley */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis|Multi Hold", meta=(AllowPrivateAccess=true))
+	bool bMultiHold = false;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis|Multi Hold", meta=(AllowPrivateAccess=true, EditCondition="bMultiHold", ClampMin=1))
+	int32 MaxHeldProps = 6;
+	/** Radius of the disc held props orbit on, around the PropSceneComponent */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis|Multi Hold", meta=(AllowPrivateAccess=true, EditCondition="bMultiHold"))
+	float OrbitRadius = 150.f;
+	/** How fast held props orbit, in deg/sec */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis|Multi Hold", meta=(AllowPrivateAccess=true, EditCondition="bMultiHold"))
+	float OrbitSpeed = 45.f;
+	/** Seconds between each prop fired in a volley */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis|Multi Hold", meta=(AllowPrivateAccess=true, EditCondition="bMultiHold"))
+	float VolleyInterval = 0.08f;
+	/** Show where our held props would go if we pushed now. Aims at the async Push trace, so needs bAsyncTraces */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis|Trajectory", meta=(AllowPrivateAccess=true))
+	bool bShowTrajectory = true;
+	/** How far ahead we predict, in seconds of Reach */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis|Trajectory", meta=(AllowPrivateAccess=true, ClampMin=0))
+	float TrajectorySeconds = 1.f;
+	/** Reach steps between each drawn sample */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis|Trajectory", meta=(AllowPrivateAccess=true, ClampMin=1))
+	int32 TrajectorySampleInterval = 3;
+	/** The first prop's path is swept against the world in this many straight segments, so the preview stops where it would hit */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis|Trajectory", meta=(AllowPrivateAccess=true, ClampMin=0))
+	int32 TrajectorySweepSegments = 4;
+	/** Game thread time the preview may take each frame, we predict less far ahead while we're over it */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis|Trajectory", meta=(AllowPrivateAccess=true, ClampMin=0))
+	float TrajectoryBudgetMicroseconds = 50.f;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis|Trajectory", meta=(AllowPrivateAccess=true))
+	FVector TrajectorySampleScale = FVector(0.1f);
 	/** The strength of our Push  */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Telekinesis", meta=(AllowPrivateAccess=true))
 	float PushTraceDistance = 20000.f;
@@ -112,10 +199,82 @@ private:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Telekinesis", meta=(AllowPrivateAccess=true))
 	class UAnimMontage* PushAnimMontage = nullptr;
 	
+	/** Target acquisition scratch data, kept around so we don't allocate every frame */
+	TArray<TEnumAsByte<EObjectTypeQuery>> TargetObjectTypes;
+	TArray<AActor*> TargetActorsToIgnore;
+	TArray<FTelekineticPropCandidate> TargetCandidates;
+	FTelekinesisHighlightManager HighlightManager;
+	int32 FramesSinceTargetScoring = 0;
+
+	/** Async traces in flight, and the last results they gave us */
+	FTraceHandle TargetTraceHandle;
+	FTraceHandle PushTraceHandle;
+	TWeakObjectPtr<ATelekineticActor> AsyncTarget;
+	float AsyncTargetDistance = 0.f;
+	FVector PushTraceStart = FVector::ZeroVector;
+	FVector PushTraceDirection = FVector::ZeroVector;
+	FVector PushTraceImpactPoint = FVector::ZeroVector;
+	FVector PendingPushTraceStart = FVector::ZeroVector;
+	FVector PendingPushTraceDirection = FVector::ZeroVector;
+	bool bPushTraceResultValid = false;
+
+	/** Trajectory preview state, see UpdateTrajectoryPreview */
+	FTelekinesisTrajectoryBatch TrajectoryBatch;
+	TArray<FTransform> TrajectoryTransforms;
+	TArray<FTraceHandle> TrajectorySweepHandles;
+	/** Distance along the path to the start of each sweep segment */
+	TArray<float> TrajectorySweepStartLengths;
+	/** How far along its path the first prop hits something, from last frame's sweeps */
+	float TrajectoryHitLength = TNumericLimits<float>::Max();
+	/** Reach steps we predict, shortened while we're over budget */
+	int32 TrajectorySteps = 0;
+
+	/** Orbit slot locations for held props, solved once per frame */
+	TArray<FVector> HoldSlotLocations;
+	/** Props already fired in the current volley, our Push trace ignores them */
+	TArray<AActor*> VolleyProps;
+	float VolleyCountdown = 0.f;
+	bool bVolleyActive = false;
+
+	/** Functions for holding several props at once */
+	bool CanHoldMoreProps() const;
+	void SolveHoldSlots();
+	void UpdateVolley(float DeltaSeconds);
+	void FireNextVolleyProp();
+
+	/** Functions for finding the prop we're aiming at */
+	class ATelekineticActor* FindTargetInPropGrid(const FVector& StartLocation, const FVector& EndLocation, float& OutDistance);
+	class ATelekineticActor* FindTargetWithTrace(const FVector& StartLocation, const FVector& EndLocation, float& OutDistance);
+	bool IsAimingAt(const ATelekineticActor* Prop, const FVector& StartLocation, const FVector& EndLocation) const;
+	/** Have an idle prop entity we're aiming at promoted to its actor if it's closer than ActorDistance, so we can target it next frame */
+	void AcquireTargetEntity(const FVector& StartLocation, const FVector& EndLocation, float ActorDistance);
+
+	/** Read last frame's async traces and request this frame's */
+	void UpdateAsyncTraces(const FVector& StartLocation, const FVector& EndLocation);
+	bool CanReusePushTrace() const;
+	void GetPushTraceIgnoredActors(TArray<AActor*>& OutActors) const;
+
+	/** Functions for previewing where a Push would send our held props */
+	void UpdateTrajectoryPreview();
+	void HideTrajectoryPreview();
+	/** Read last frame's trajectory sweeps into TrajectoryHitLength and request this frame's along LeadProp's lane */
+	void UpdateTrajectorySweeps(class UTelekinesisWorldSubsystem* TelekinesisSubsystem, const class ATelekineticActor* LeadProp);
+	void UpdateTrajectoryInstances();
+
 	/** Functions for setting up pulling and pushing objects */
 	void Push();
 	void PushTrace(FVector& ImpactPoint);
 	void Pull();
+	void ExitTelekinesis();
+
+	/** Clients predict Pull and Push locally and ask the server to do the same */
+	UFUNCTION(Server, Reliable)
+	void ServerPull(class ATelekineticActor* Prop);
+	UFUNCTION(Server, Reliable)
+	void ServerPush();
+	/** The server wouldn't let us Pull a prop we predicted pulling */
+	UFUNCTION(Client, Reliable)
+	void ClientRejectPull(class ATelekineticActor* Prop);
 
 	/** Helper function to add CameraOffsetRight and CameraOffsetUp to camera boom location */
 	void AddCameraBoomOffset() const;
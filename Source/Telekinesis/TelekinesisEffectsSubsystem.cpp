@@ -0,0 +1,188 @@
+#include "TelekinesisEffectsSubsystem.h"
+#include "Components/AudioComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "NiagaraComponent.h"
+#include "NiagaraSystem.h"
+#include "Sound/SoundBase.h"
+
+void UTelekinesisEffectsSubsystem::Deinitialize()
+{
+	for (UNiagaraComponent* Component : SparksComponents)
+	{
+		if (IsValid(Component))
+		{
+			Component->DestroyComponent();
+		}
+	}
+	for (UAudioComponent* Component : SoundComponents)
+	{
+		if (IsValid(Component))
+		{
+			Component->DestroyComponent();
+		}
+	}
+	SparksComponents.Empty();
+	SoundComponents.Empty();
+	LastSparksSeconds.Empty();
+	LastSoundSeconds.Empty();
+	Super::Deinitialize();
+}
+
+void UTelekinesisEffectsSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (InWorld.GetNetMode() == NM_DedicatedServer)
+	{
+		return;
+	}
+
+	// Like UNiagaraFunctionLibrary::SpawnSystemAtLocation, outer the components to the world settings so they aren't tied to any prop
+	UObject* Outer = InWorld.GetWorldSettings() ? static_cast<UObject*>(InWorld.GetWorldSettings()) : static_cast<UObject*>(&InWorld);
+
+	SparksComponents.Reserve(NumSparksComponents);
+	for (int32 Index = 0; Index < NumSparksComponents; ++Index)
+	{
+		UNiagaraComponent* Component = NewObject<UNiagaraComponent>(Outer);
+		Component->SetAutoActivate(false);
+		Component->SetAutoDestroy(false);
+		Component->RegisterComponentWithWorld(&InWorld);
+		SparksComponents.Add(Component);
+	}
+
+	SoundComponents.Reserve(NumSoundComponents);
+	for (int32 Index = 0; Index < NumSoundComponents; ++Index)
+	{
+		UAudioComponent* Component = NewObject<UAudioComponent>(Outer);
+		Component->bAutoActivate = false;
+		Component->bAutoDestroy = false;
+		Component->bAllowSpatialization = false;
+		Component->bIsUISound = false;
+		Component->RegisterComponentWithWorld(&InWorld);
+		SoundComponents.Add(Component);
+	}
+}
+
+bool UTelekinesisEffectsSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTelekinesisEffectsSubsystem::UpdateBudgetFrame()
+{
+	if (BudgetFrame != GFrameCounter)
+	{
+		BudgetFrame = GFrameCounter;
+		NumSparksThisFrame = 0;
+		NumSoundsThisFrame = 0;
+	}
+}
+
+template<typename KeyType>
+bool UTelekinesisEffectsSubsystem::ConsumeInterval(TMap<KeyType, double>& LastSeconds, const KeyType& Key, float IntervalSeconds)
+{
+	const double NowSeconds = GetWorld()->GetTimeSeconds();
+	double& LastTimeSeconds = LastSeconds.FindOrAdd(Key, -DBL_MAX);
+	if (NowSeconds - LastTimeSeconds < IntervalSeconds)
+	{
+		return false;
+	}
+	LastTimeSeconds = NowSeconds;
+
+	// Forget sources that have gone quiet now and then, so destroyed props don't build up
+	if (LastSeconds.Num() > 256)
+	{
+		for (auto It = LastSeconds.CreateIterator(); It; ++It)
+		{
+			if (NowSeconds - It.Value() >= IntervalSeconds)
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+	return true;
+}
+
+template<typename ComponentType>
+ComponentType* UTelekinesisEffectsSubsystem::GetPooledComponent(TArray<ComponentType*>& Components, int32& NextComponent)
+{
+	if (Components.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	// Components are handed out in turn, so the next one along is the idle one or the one that's played longest
+	for (int32 Offset = 0; Offset < Components.Num(); ++Offset)
+	{
+		const int32 Index = (NextComponent + Offset) % Components.Num();
+		if (!Components[Index]->IsActive())
+		{
+			NextComponent = (Index + 1) % Components.Num();
+			return Components[Index];
+		}
+	}
+	ComponentType* Component = Components[NextComponent];
+	NextComponent = (NextComponent + 1) % Components.Num();
+	return Component;
+}
+
+bool UTelekinesisEffectsSubsystem::ConsumeSparksBudget(const UObject* Source)
+{
+	UpdateBudgetFrame();
+	if (NumSparksThisFrame >= MaxSparksPerFrame || !ConsumeInterval(LastSparksSeconds, FObjectKey(Source), MinSparksIntervalSeconds))
+	{
+		return false;
+	}
+	++NumSparksThisFrame;
+	return true;
+}
+
+bool UTelekinesisEffectsSubsystem::SpawnSparks(const UObject* Source, UNiagaraSystem* System, const FVector& Location, const FVector& Direction, FName DirectionParameter)
+{
+	if (System == nullptr || !ConsumeSparksBudget(Source))
+	{
+		return false;
+	}
+
+	UNiagaraComponent* Component = GetPooledComponent(SparksComponents, NextSparksComponent);
+	if (Component == nullptr)
+	{
+		return false;
+	}
+	if (Component->GetAsset() != System)
+	{
+		Component->SetAsset(System);
+	}
+	Component->SetWorldLocationAndRotation(Location, Direction.Rotation());
+	if (!DirectionParameter.IsNone())
+	{
+		Component->SetVariableVec3(DirectionParameter, Direction);
+	}
+	Component->Activate(true);
+	return true;
+}
+
+bool UTelekinesisEffectsSubsystem::PlaySound2D(const UObject* Source, USoundBase* Sound)
+{
+	if (Sound == nullptr)
+	{
+		return false;
+	}
+
+	UpdateBudgetFrame();
+	if (NumSoundsThisFrame >= MaxSoundsPerFrame || !ConsumeInterval(LastSoundSeconds, TPair<FObjectKey, FObjectKey>(Source, Sound), MinSoundIntervalSeconds))
+	{
+		return false;
+	}
+
+	UAudioComponent* Component = GetPooledComponent(SoundComponents, NextSoundComponent);
+	if (Component == nullptr)
+	{
+		return false;
+	}
+	++NumSoundsThisFrame;
+	Component->SetSound(Sound);
+	Component->Play();
+	return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "TelekinesisEffectsSubsystem.generated.h"
+
+/**
+ * Pools the one-shot effects props fire a lot, impact sparks and 2D telekinesis sounds.
+ * Components are created up front and reused, each kind of effect has a per frame budget, and the same prop can't
+ * repeat an effect faster than its minimum interval, so long chains of props hitting each other don't spawn hitches or garbage.
+ */
+UCLASS()
+class TELEKINESIS_API UTelekinesisEffectsSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual void Deinitialize() override;
+	// End of USubsystem interface
+
+	// UWorldSubsystem interface
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	// End of UWorldSubsystem interface
+
+	/**
+	 * Check Source may spawn sparks now, and count them against this frame's budget if so.
+	 * Use on its own when something else spawns the sparks, e.g. a Blueprint.
+	 */
+	bool ConsumeSparksBudget(const UObject* Source);
+	/** Spawn sparks from the pool, returns false if we're over budget or Source sparked too recently */
+	bool SpawnSparks(const UObject* Source, class UNiagaraSystem* System, const FVector& Location, const FVector& Direction, FName DirectionParameter);
+	/** Play a 2D sound from the pool, returns false if we're over budget or Source played it too recently */
+	bool PlaySound2D(const UObject* Source, class USoundBase* Sound);
+
+	// Pool sizes, allocated when the world begins play
+	int32 NumSparksComponents = 16;
+	int32 NumSoundComponents = 8;
+	// Per frame budgets, anything over them is dropped
+	int32 MaxSparksPerFrame = 4;
+	int32 MaxSoundsPerFrame = 4;
+	/** Seconds before the same prop can spark again */
+	float MinSparksIntervalSeconds = 0.1f;
+	/** Seconds before the same prop can play the same sound again */
+	float MinSoundIntervalSeconds = 0.05f;
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	UPROPERTY()
+	TArray<class UNiagaraComponent*> SparksComponents;
+	UPROPERTY()
+	TArray<class UAudioComponent*> SoundComponents;
+	int32 NextSparksComponent = 0;
+	int32 NextSoundComponent = 0;
+
+	uint64 BudgetFrame = 0;
+	int32 NumSparksThisFrame = 0;
+	int32 NumSoundsThisFrame = 0;
+
+	// When each source last played an effect
+	TMap<FObjectKey, double> LastSparksSeconds;
+	TMap<TPair<FObjectKey, FObjectKey>, double> LastSoundSeconds;
+
+	/** Reset the budgets on the first effect of a frame */
+	void UpdateBudgetFrame();
+	/** Returns false if Key played within IntervalSeconds, otherwise records it as playing now */
+	template<typename KeyType>
+	bool ConsumeInterval(TMap<KeyType, double>& LastSeconds, const KeyType& Key, float IntervalSeconds);
+	/** An idle pooled component, or the one that's been playing longest if they're all busy */
+	template<typename ComponentType>
+	ComponentType* GetPooledComponent(TArray<ComponentType*>& Components, int32& NextComponent);
+
+};
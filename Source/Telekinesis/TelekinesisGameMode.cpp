@@ -2,6 +2,7 @@
 
 #include "TelekinesisGameMode.h"
 #include "TelekinesisCharacter.h"
+#include "TelekinesisStressTest.h"
 #include "UObject/ConstructorHelpers.h"
 
 ATelekinesisGameMode::ATelekinesisGameMode()
@@ -13,3 +14,14 @@ ATelekinesisGameMode::ATelekinesisGameMode()
 		DefaultPawnClass = PlayerPawnBPClass.Class;
 	}
 }
+
+void ATelekinesisGameMode::StartPlay()
+{
+	Super::StartPlay();
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("TelekinesisStressTest")))
+	{
+		ATelekinesisStressTest* StressTest = GetWorld()->SpawnActor<ATelekinesisStressTest>();
+		StressTest->bQuitWhenFinished = true;
+	}
+}
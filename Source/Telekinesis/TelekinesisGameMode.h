@@ -13,6 +13,9 @@ class ATelekinesisGameMode : public AGameModeBase
 
 public:
 	ATelekinesisGameMode();
+
+	/** Spawns an ATelekinesisStressTest when the game is started with -TelekinesisStressTest */
+	virtual void StartPlay() override;
 };
 
 
@@ -0,0 +1,85 @@
+#include "TelekinesisHighlightManager.h"
+#include "TelekineticActor.h"
+
+void FTelekinesisHighlightManager::Update(ATelekineticActor* Candidate, float Score, float DeltaSeconds)
+{
+	ATelekineticActor* CurrentTarget = Target.Get();
+	// Same target, just track its score
+	if (Candidate == CurrentTarget)
+	{
+		TargetScore = Score;
+		bHasPendingCandidate = false;
+		return;
+	}
+	// Nothing targeted yet, or a clearly better candidate, switch straight away so there's no visible latency
+	if (CurrentTarget == nullptr || (Candidate != nullptr && Score >= TargetScore + ScoreMargin))
+	{
+		SetTarget(Candidate, Score);
+		return;
+	}
+	// Otherwise the candidate has to stay best for the whole hysteresis window
+	if (!bHasPendingCandidate || PendingCandidate.Get() != Candidate)
+	{
+		PendingCandidate = Candidate;
+		PendingSeconds = 0.f;
+		bHasPendingCandidate = true;
+	}
+	PendingScore = Score;
+	PendingSeconds += DeltaSeconds;
+	if (PendingSeconds >= HysteresisSeconds)
+	{
+		SetTarget(Candidate, Score);
+	}
+}
+
+void FTelekinesisHighlightManager::KeepTarget(float DeltaSeconds)
+{
+	if (bHasPendingCandidate)
+	{
+		Update(PendingCandidate.Get(), PendingScore, DeltaSeconds);
+	}
+}
+
+void FTelekinesisHighlightManager::ForgetTarget()
+{
+	Target.Reset();
+	TargetScore = 0.f;
+	HighlightedProp.Reset();
+	bHasPendingCandidate = false;
+}
+
+void FTelekinesisHighlightManager::Flush()
+{
+	ATelekineticActor* CurrentTarget = Target.Get();
+	ATelekineticActor* CurrentHighlight = HighlightedProp.Get();
+	if (CurrentTarget == CurrentHighlight)
+	{
+		return;
+	}
+	if (CurrentHighlight != nullptr)
+	{
+		CurrentHighlight->Highlight(false);
+	}
+	if (CurrentTarget != nullptr)
+	{
+		CurrentTarget->Highlight(true);
+	}
+	HighlightedProp = CurrentTarget;
+}
+
+ATelekineticActor* FTelekinesisHighlightManager::GetTarget() const
+{
+	return Target.Get();
+}
+
+float FTelekinesisHighlightManager::GetTargetScore() const
+{
+	return TargetScore;
+}
+
+void FTelekinesisHighlightManager::SetTarget(ATelekineticActor* NewTarget, float NewScore)
+{
+	Target = NewTarget;
+	TargetScore = NewScore;
+	bHasPendingCandidate = false;
+}
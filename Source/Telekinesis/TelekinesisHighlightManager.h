@@ -0,0 +1,45 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Decides which prop is highlighted as our telekinesis target.
+ * Debounces target changes so sweeping the crosshair over a dense cluster doesn't flicker,
+ * and only touches custom depth render state once per frame in Flush().
+ */
+class TELEKINESIS_API FTelekinesisHighlightManager
+{
+public:
+	/** Seconds a different candidate (or no candidate) has to stay best before we switch to it */
+	float HysteresisSeconds = 0.1f;
+	/** A candidate scoring this much better than our target is switched to immediately */
+	float ScoreMargin = 0.25f;
+
+	/** Offer this frame's best candidate and its score, higher is better. Pass nullptr when nothing is in view */
+	void Update(class ATelekineticActor* Candidate, float Score, float DeltaSeconds);
+	/** Keep our current target for this frame, e.g. on frames where we skip scoring */
+	void KeepTarget(float DeltaSeconds);
+	/** Drop our target without touching its highlight, e.g. when it's pulled and unhighlights itself */
+	void ForgetTarget();
+	/** Apply any highlight change, at most one custom depth toggle per prop per frame */
+	void Flush();
+
+	ATelekineticActor* GetTarget() const;
+	float GetTargetScore() const;
+
+private:
+	TWeakObjectPtr<ATelekineticActor> Target;
+	float TargetScore = 0.f;
+
+	/** A candidate waiting out the hysteresis window before it replaces our target */
+	TWeakObjectPtr<ATelekineticActor> PendingCandidate;
+	float PendingScore = 0.f;
+	float PendingSeconds = 0.f;
+	bool bHasPendingCandidate = false;
+
+	/** The prop we've actually set custom depth on */
+	TWeakObjectPtr<ATelekineticActor> HighlightedProp;
+
+	void SetTarget(ATelekineticActor* NewTarget, float NewScore);
+
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * The Lift and Reach math, shared by ATelekineticActor's game thread paths and FTelekinesisSimCallback on the physics thread.
+ * Plain core math, inlined into each caller, so a step is a few vector ops. Anything that can't change during a Pull,
+ * like the prop's mass multiplier, is captured when it's pulled and passed in.
+ */
+struct FTelekinesisReachKernel
+{
+	/** Reach impulses stop growing beyond this distance from the target */
+	static constexpr float MaxImpulseDistance = 1000.f;
+
+	/**
+	 * Velocity change per ReachTimeStep towards Target. Scale is the prop's mass multiplier times its pull or push speed.
+	 * Constant speed reaches ignore distance, others pull harder the further away they are.
+	 */
+	static FORCEINLINE FVector GetImpulse(const FVector& From, const FVector& Target, float Scale, bool bConstantSpeed)
+	{
+		FVector MoveDirection = Target - From;
+		if (bConstantSpeed)
+		{
+			MoveDirection = MoveDirection.GetSafeNormal();
+		}
+		return MoveDirection.GetClampedToMaxSize(MaxImpulseDistance) * Scale;
+	}
+
+	/** Velocity scale for one step of linear damping, matching the physics engine's */
+	static FORCEINLINE float GetDampingScale(float LinearDamping, float DeltaTime)
+	{
+		return 1.f / (1.f + LinearDamping * DeltaTime);
+	}
+
+	/** How far through its Lift a prop is, clamped to [0, 1] */
+	static FORCEINLINE float GetLiftAlpha(float CurrTimeSeconds, float StartTimeSeconds, float EndTimeSeconds)
+	{
+		const float Duration = EndTimeSeconds - StartTimeSeconds;
+		if (Duration <= 0.f)
+		{
+			return CurrTimeSeconds >= EndTimeSeconds ? 1.f : 0.f;
+		}
+		return FMath::Clamp((CurrTimeSeconds - StartTimeSeconds) / Duration, 0.f, 1.f);
+	}
+
+	/** Height to move to this Lift step, eased from the current height towards the target */
+	static FORCEINLINE float GetLiftHeight(float CurrentZ, float TargetZ, float Alpha)
+	{
+		return FMath::Lerp(CurrentZ, TargetZ, Alpha);
+	}
+};
@@ -0,0 +1,358 @@
+#include "TelekinesisReplaySubsystem.h"
+#include "Telekinesis.h"
+#include "TelekinesisCharacter.h"
+#include "TelekineticActor.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/PlayerController.h"
+#include "Kismet/GameplayStatics.h"
+#include "Kismet/KismetSystemLibrary.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+FArchive& operator<<(FArchive& Ar, FTelekinesisReplayPropState& PropState)
+{
+	Ar << PropState.PropId;
+	Ar << PropState.State;
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FTelekinesisReplayFrame& Frame)
+{
+	Ar << Frame.Flags;
+	if (Frame.Flags & FTelekinesisReplayFrame::Flag_MoveForward)
+	{
+		Ar << Frame.MoveForward;
+	}
+	if (Frame.Flags & FTelekinesisReplayFrame::Flag_MoveRight)
+	{
+		Ar << Frame.MoveRight;
+	}
+	if (Frame.Flags & FTelekinesisReplayFrame::Flag_ControlRotation)
+	{
+		Ar << Frame.ControlRotation;
+	}
+	if (Frame.Flags & FTelekinesisReplayFrame::Flag_PropStates)
+	{
+		Ar << Frame.PropStates;
+	}
+	return Ar;
+}
+
+void UTelekinesisReplaySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	FParse::Value(CommandLine, TEXT("TKSeed="), RandomSeed);
+	FString FileName;
+	if (FParse::Value(CommandLine, TEXT("TKReplay="), FileName))
+	{
+		Mode = EMode::Replay;
+	}
+	else if (FParse::Value(CommandLine, TEXT("TKRecord="), FileName))
+	{
+		Mode = EMode::Record;
+		float FramesPerSecond = 60.f;
+		FParse::Value(CommandLine, TEXT("TKReplayFPS="), FramesPerSecond);
+		FixedDeltaSeconds = 1.f / FMath::Max(FramesPerSecond, 1.f);
+	}
+	else
+	{
+		return;
+	}
+	bQuitWhenFinished = FParse::Param(CommandLine, TEXT("TKReplayQuit"));
+	FilePath = FPaths::IsRelative(FileName) ? FPaths::ProjectSavedDir() / TEXT("TelekinesisReplays") / FileName : FileName;
+
+	// The replay brings its own seed and time step
+	if (Mode == EMode::Replay && !LoadReplay())
+	{
+		Mode = EMode::None;
+		return;
+	}
+}
+
+void UTelekinesisReplaySubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldTickStart.Remove(WorldTickStartHandle);
+	FWorldDelegates::OnWorldPostActorTick.Remove(WorldPostActorTickHandle);
+	if (Mode == EMode::Record && FrameIndex != INDEX_NONE)
+	{
+		SaveRecording();
+	}
+	// Hand the time step back to whoever owns the app next, e.g. the editor after a PIE session
+	if (bOverrodeTimeStep)
+	{
+		FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+		FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+		bOverrodeTimeStep = false;
+	}
+	Mode = EMode::None;
+	Character = nullptr;
+	Frames.Empty();
+	Super::Deinitialize();
+}
+
+void UTelekinesisReplaySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (Mode == EMode::None)
+	{
+		return;
+	}
+	if (InWorld.GetNetMode() != NM_Standalone)
+	{
+		UE_LOG(LogTelekinesis, Warning, TEXT("Telekinesis replays only work in standalone games, not recording or replaying %s"), *FilePath);
+		Mode = EMode::None;
+		return;
+	}
+
+	// The time step and global streams belong to the whole app, so only take them over once we know we'll run
+	bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+	PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+	bOverrodeTimeStep = true;
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(FixedDeltaSeconds);
+	// Anything else drawing from the global streams, e.g. Blueprints, should take the same path too
+	FMath::RandInit(RandomSeed);
+	FMath::SRandInit(RandomSeed);
+
+	WorldTickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &UTelekinesisReplaySubsystem::OnWorldTickStart);
+	WorldPostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UTelekinesisReplaySubsystem::OnWorldPostActorTick);
+}
+
+bool UTelekinesisReplaySubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTelekinesisReplaySubsystem::SetRandomSeed(int32 InRandomSeed)
+{
+	RandomSeed = InRandomSeed;
+	for (TActorIterator<ATelekineticActor> It(GetWorld()); It; ++It)
+	{
+		It->SeedRandomStream();
+	}
+}
+
+uint32 UTelekinesisReplaySubsystem::GetPropId(const AActor* Prop)
+{
+	return FCrc::StrCrc32(*Prop->GetName());
+}
+
+void UTelekinesisReplaySubsystem::RecordInput(const ATelekinesisCharacter* InCharacter, ETelekinesisReplayInput Input)
+{
+	if (Mode == EMode::Record && InCharacter == Character && FrameIndex != INDEX_NONE)
+	{
+		CurrentFrame.Flags |= 1 << static_cast<uint8>(Input);
+	}
+}
+
+void UTelekinesisReplaySubsystem::RecordAxis(const ATelekinesisCharacter* InCharacter, ETelekinesisReplayAxis Axis, float Value)
+{
+	if (Mode != EMode::Record || InCharacter != Character || FrameIndex == INDEX_NONE || Value == 0.f)
+	{
+		return;
+	}
+	if (Axis == ETelekinesisReplayAxis::MoveForward)
+	{
+		CurrentFrame.Flags |= FTelekinesisReplayFrame::Flag_MoveForward;
+		CurrentFrame.MoveForward = Value;
+	}
+	else
+	{
+		CurrentFrame.Flags |= FTelekinesisReplayFrame::Flag_MoveRight;
+		CurrentFrame.MoveRight = Value;
+	}
+}
+
+void UTelekinesisReplaySubsystem::RecordPropState(const AActor* Prop, ETelekinesisStates NewState)
+{
+	if ((Mode == EMode::Record || Mode == EMode::Replay) && FrameIndex != INDEX_NONE)
+	{
+		CurrentFrame.Flags |= FTelekinesisReplayFrame::Flag_PropStates;
+		CurrentFrame.PropStates.Add({GetPropId(Prop), NewState});
+	}
+}
+
+bool UTelekinesisReplaySubsystem::LoadReplay()
+{
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *FilePath))
+	{
+		UE_LOG(LogTelekinesis, Error, TEXT("Couldn't read telekinesis replay %s"), *FilePath);
+		return false;
+	}
+	FMemoryReader Reader(Data);
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	Reader << Magic;
+	Reader << Version;
+	if (Magic != FileMagic || Version != FileVersion)
+	{
+		UE_LOG(LogTelekinesis, Error, TEXT("%s isn't a version %u telekinesis replay"), *FilePath, FileVersion);
+		return false;
+	}
+	Reader << RandomSeed;
+	Reader << FixedDeltaSeconds;
+	Reader << Frames;
+	if (Reader.IsError() || FixedDeltaSeconds <= 0.f)
+	{
+		UE_LOG(LogTelekinesis, Error, TEXT("Telekinesis replay %s is corrupt"), *FilePath);
+		return false;
+	}
+	UE_LOG(LogTelekinesis, Display, TEXT("Replaying %d frames of %.4fs from %s"), Frames.Num(), FixedDeltaSeconds, *FilePath);
+	return true;
+}
+
+bool UTelekinesisReplaySubsystem::SaveRecording()
+{
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+	uint32 Magic = FileMagic;
+	uint32 Version = FileVersion;
+	int32 Seed = RandomSeed;
+	float DeltaSeconds = FixedDeltaSeconds;
+	Writer << Magic;
+	Writer << Version;
+	Writer << Seed;
+	Writer << DeltaSeconds;
+	Writer << Frames;
+	if (!FFileHelper::SaveArrayToFile(Data, *FilePath))
+	{
+		UE_LOG(LogTelekinesis, Error, TEXT("Couldn't write telekinesis replay %s"), *FilePath);
+		return false;
+	}
+	UE_LOG(LogTelekinesis, Display, TEXT("Recorded %d frames to %s, %d bytes"), Frames.Num(), *FilePath, Data.Num());
+	return true;
+}
+
+bool UTelekinesisReplaySubsystem::FindCharacter()
+{
+	Character = Cast<ATelekinesisCharacter>(UGameplayStatics::GetPlayerCharacter(this, 0));
+	return Character != nullptr && Character->GetController() != nullptr;
+}
+
+void UTelekinesisReplaySubsystem::ApplyFrame(const FTelekinesisReplayFrame& Frame)
+{
+	// The recorded inputs ran before the player controller turned the camera, so they still see last frame's control rotation
+	Character->TurnRight(0.f);
+	if (Frame.Flags & FTelekinesisReplayFrame::Flag_MoveForward)
+	{
+		Character->MoveForward(Frame.MoveForward);
+	}
+	if (Frame.Flags & FTelekinesisReplayFrame::Flag_MoveRight)
+	{
+		Character->MoveRight(Frame.MoveRight);
+	}
+	if (Frame.HasInput(ETelekinesisReplayInput::StopJumping))
+	{
+		Character->StopJumping();
+	}
+	if (Frame.HasInput(ETelekinesisReplayInput::Jump))
+	{
+		Character->Jump();
+	}
+	if (Frame.HasInput(ETelekinesisReplayInput::Telekinesis))
+	{
+		Character->InputTelekinesis();
+	}
+	if (Frame.Flags & FTelekinesisReplayFrame::Flag_ControlRotation)
+	{
+		LastControlRotation = Frame.ControlRotation;
+	}
+	Character->GetController()->SetControlRotation(FRotator(LastControlRotation));
+}
+
+void UTelekinesisReplaySubsystem::CheckFrame(const FTelekinesisReplayFrame& Recorded)
+{
+	if (CurrentFrame.PropStates == Recorded.PropStates)
+	{
+		return;
+	}
+	if (NumDivergentFrames++ == 0)
+	{
+		UE_LOG(LogTelekinesis, Warning, TEXT("Telekinesis replay diverged on frame %d, %d prop state changes recorded and %d replayed"),
+			FrameIndex, Recorded.PropStates.Num(), CurrentFrame.PropStates.Num());
+	}
+}
+
+void UTelekinesisReplaySubsystem::FinishReplay()
+{
+	Mode = EMode::Finished;
+	if (Character && Character->GetController())
+	{
+		Character->EnableInput(Cast<APlayerController>(Character->GetController()));
+	}
+	UE_LOG(LogTelekinesis, Display, TEXT("Finished replaying %s, %d of %d frames diverged"), *FilePath, NumDivergentFrames, Frames.Num());
+	if (bQuitWhenFinished)
+	{
+		UKismetSystemLibrary::QuitGame(this, nullptr, EQuitPreference::Quit, false);
+	}
+}
+
+void UTelekinesisReplaySubsystem::OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld() || World->IsPaused() || (Mode != EMode::Record && Mode != EMode::Replay))
+	{
+		return;
+	}
+	// Both sides start on the first frame the player is possessed, a recording just pauses if the player goes away
+	if (Mode == EMode::Record && FrameIndex != INDEX_NONE && (!IsValid(Character) || Character->GetController() == nullptr))
+	{
+		return;
+	}
+	if (FrameIndex == INDEX_NONE)
+	{
+		if (!FindCharacter())
+		{
+			return;
+		}
+		if (Mode == EMode::Replay)
+		{
+			// From here on the player only sees the replay's inputs
+			Character->DisableInput(Cast<APlayerController>(Character->GetController()));
+		}
+	}
+	++FrameIndex;
+	CurrentFrame = FTelekinesisReplayFrame();
+	if (Mode == EMode::Replay)
+	{
+		if (!Frames.IsValidIndex(FrameIndex) || !IsValid(Character) || Character->GetController() == nullptr)
+		{
+			FinishReplay();
+			return;
+		}
+		ApplyFrame(Frames[FrameIndex]);
+	}
+}
+
+void UTelekinesisReplaySubsystem::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld() || World->IsPaused() || FrameIndex == INDEX_NONE)
+	{
+		return;
+	}
+	if (Mode == EMode::Replay)
+	{
+		CheckFrame(Frames[FrameIndex]);
+		return;
+	}
+	if (Mode != EMode::Record || !IsValid(Character) || Character->GetController() == nullptr)
+	{
+		return;
+	}
+	const FRotator3f ControlRotation(Character->GetController()->GetControlRotation());
+	if (FrameIndex == 0 || !ControlRotation.Equals(LastControlRotation, 0.f))
+	{
+		CurrentFrame.Flags |= FTelekinesisReplayFrame::Flag_ControlRotation;
+		CurrentFrame.ControlRotation = ControlRotation;
+		LastControlRotation = ControlRotation;
+	}
+	Frames.Add(MoveTemp(CurrentFrame));
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ETelekinesisStates.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TelekinesisReplaySubsystem.generated.h"
+
+/** Player inputs we record, in the order a replay applies them within a frame */
+enum class ETelekinesisReplayInput : uint8
+{
+	StopJumping,
+	Jump,
+	Telekinesis
+};
+
+enum class ETelekinesisReplayAxis : uint8
+{
+	MoveForward,
+	MoveRight
+};
+
+/** A prop changing ETelekinesisStates during a recorded frame */
+struct FTelekinesisReplayPropState
+{
+	/** See UTelekinesisReplaySubsystem::GetPropId */
+	uint32 PropId = 0;
+	ETelekinesisStates State = ETelekinesisStates::Default;
+
+	bool operator==(const FTelekinesisReplayPropState& Other) const
+	{
+		return PropId == Other.PropId && State == Other.State;
+	}
+
+	friend FArchive& operator<<(FArchive& Ar, FTelekinesisReplayPropState& PropState);
+};
+
+/** One world tick of a recording, only the fields Flags says changed are written */
+struct FTelekinesisReplayFrame
+{
+	enum EFlags : uint8
+	{
+		// One bit per ETelekinesisReplayInput
+		Flag_Inputs = 0x07,
+		Flag_MoveForward = 0x08,
+		Flag_MoveRight = 0x10,
+		Flag_ControlRotation = 0x20,
+		Flag_PropStates = 0x40
+	};
+
+	uint8 Flags = 0;
+	float MoveForward = 0.f;
+	float MoveRight = 0.f;
+	/** The player's control rotation at the end of the frame */
+	FRotator3f ControlRotation = FRotator3f::ZeroRotator;
+	TArray<FTelekinesisReplayPropState> PropStates;
+
+	bool HasInput(ETelekinesisReplayInput Input) const { return (Flags & (1 << static_cast<uint8>(Input))) != 0; }
+
+	friend FArchive& operator<<(FArchive& Ar, FTelekinesisReplayFrame& Frame);
+};
+
+/**
+ * Records the local player's telekinesis session to a compact binary log and plays it back frame by frame, so a heavy scene
+ * can be captured once and then re-run as many times as it takes to profile an optimization.
+ * Each frame stores the player's inputs, control rotation and every prop state change. Props draw their randomness from their own
+ * FRandomStream seeded by our RandomSeed, and both sides run at the same fixed time step, so a replay takes the same path as the
+ * recording. Replays compare their prop state changes with the recorded ones and warn about the first frame they diverge.
+ * Record: Telekinesis.uproject -game -TKRecord=Heavy.tkreplay [-TKSeed=N] [-TKReplayFPS=60]
+ * Replay: Telekinesis.uproject -game -TKReplay=Heavy.tkreplay [-TKReplayQuit]
+ * Relative paths are in Saved/TelekinesisReplays. Standalone games only.
+ */
+UCLASS()
+class TELEKINESIS_API UTelekinesisReplaySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End of USubsystem interface
+
+	// UWorldSubsystem interface
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	// End of UWorldSubsystem interface
+
+	/** Seed for every prop's FRandomStream, from -TKSeed, the replay we're playing, or 0 */
+	int32 GetRandomSeed() const { return RandomSeed; }
+	/** Change the seed and reseed every prop already in the world, e.g. to match a scenario */
+	void SetRandomSeed(int32 InRandomSeed);
+	/** Identifies a prop across runs, unlike its unique ID. Spawned props get the same name as long as they spawn in the same order */
+	static uint32 GetPropId(const AActor* Prop);
+
+	bool IsRecording() const { return Mode == EMode::Record; }
+	bool IsReplaying() const { return Mode == EMode::Replay; }
+
+	// Recording hooks, these do nothing unless we're recording Character
+	void RecordInput(const class ATelekinesisCharacter* Character, ETelekinesisReplayInput Input);
+	void RecordAxis(const class ATelekinesisCharacter* Character, ETelekinesisReplayAxis Axis, float Value);
+	/** Called on any prop changing state, while recording or replaying */
+	void RecordPropState(const AActor* Prop, ETelekinesisStates NewState);
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	enum class EMode : uint8
+	{
+		None,
+		Record,
+		Replay,
+		Finished
+	};
+
+	static constexpr uint32 FileMagic = 0x504B5454; // "TTKP"
+	static constexpr uint32 FileVersion = 1;
+
+	EMode Mode = EMode::None;
+	FString FilePath;
+	int32 RandomSeed = 0;
+	float FixedDeltaSeconds = 1.f / 60.f;
+	bool bQuitWhenFinished = false;
+	/** The app's time step before we fixed it, restored in Deinitialize */
+	bool bOverrodeTimeStep = false;
+	bool bPreviousUseFixedTimeStep = false;
+	double PreviousFixedDeltaTime = 0.0;
+
+	UPROPERTY()
+	class ATelekinesisCharacter* Character = nullptr;
+	TArray<FTelekinesisReplayFrame> Frames;
+	/** The frame being recorded or replayed */
+	int32 FrameIndex = INDEX_NONE;
+	FTelekinesisReplayFrame CurrentFrame;
+	FRotator3f LastControlRotation = FRotator3f::ZeroRotator;
+	int32 NumDivergentFrames = 0;
+
+	FDelegateHandle WorldTickStartHandle;
+	FDelegateHandle WorldPostActorTickHandle;
+
+	bool LoadReplay();
+	bool SaveRecording();
+	/** Look for the local player's character, returns false until it's possessed */
+	bool FindCharacter();
+	void ApplyFrame(const FTelekinesisReplayFrame& Frame);
+	void CheckFrame(const FTelekinesisReplayFrame& Recorded);
+	void FinishReplay();
+
+	void OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+};
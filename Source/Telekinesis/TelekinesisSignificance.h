@@ -0,0 +1,30 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TelekinesisSignificance.generated.h"
+
+/**
+ * How much a held or pushed prop does at one distance from the nearest viewer, see UTelekineticPropArchetype::SignificanceBuckets.
+ * Intervals count Reach steps, so 1 is every step.
+ */
+USTRUCT(BlueprintType)
+struct TELEKINESIS_API FTelekinesisSignificanceBucket
+{
+	GENERATED_BODY()
+
+	/** Props up to this far from a viewer fall in this bucket, if the viewer can see them */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Significance")
+	float MaxDistance = 0.f;
+	/** Steps between feeding our location to the particle system, 0 never feeds it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Significance", meta=(ClampMin=0))
+	int32 ParticleFeedInterval = 1;
+	/** Steps between Jitter and mini prop attraction updates, attraction is scaled up to pull as hard overall */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Significance", meta=(ClampMin=1))
+	int32 PhysicsInterval = 1;
+	/** Whether the wind sound may play */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Significance")
+	bool bAudio = true;
+	/** Scales NiagaraSpawnRate */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Significance", meta=(ClampMin=0))
+	float NiagaraSpawnRateScale = 1.f;
+};
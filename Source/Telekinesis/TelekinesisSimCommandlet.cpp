@@ -0,0 +1,318 @@
+#include "TelekinesisSimCommandlet.h"
+#include "Telekinesis.h"
+#include "TelekinesisCharacter.h"
+#include "TelekinesisReplaySubsystem.h"
+#include "TelekinesisWorldSubsystem.h"
+#include "TelekineticActor.h"
+#include "MiniTelekineticActor.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/WorldSettings.h"
+#include "JsonObjectConverter.h"
+#include "Misc/App.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+
+UTelekinesisSimCommandlet::UTelekinesisSimCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UTelekinesisSimCommandlet::Main(const FString& Params)
+{
+	FString ScenarioPath;
+	if (!FParse::Value(*Params, TEXT("Scenario="), ScenarioPath))
+	{
+		UE_LOG(LogTelekinesis, Error, TEXT("Usage: -run=TelekinesisSim -Scenario=Path/To/Scenario.json [-Out=Dir]"));
+		return 1;
+	}
+	FString ScenarioJson;
+	FTelekinesisSimScenario Scenario;
+	if (!FFileHelper::LoadFileToString(ScenarioJson, *ScenarioPath) || !FJsonObjectConverter::JsonObjectStringToUStruct(ScenarioJson, &Scenario))
+	{
+		UE_LOG(LogTelekinesis, Error, TEXT("Couldn't read scenario %s"), *ScenarioPath);
+		return 1;
+	}
+	FString OutputDir = FPaths::ProfilingDir() / TEXT("TelekinesisSim");
+	FParse::Value(*Params, TEXT("Out="), OutputDir);
+	if (Scenario.Map.IsEmpty())
+	{
+		GConfig->GetString(TEXT("/Script/EngineSettings.GameMapsSettings"), TEXT("GameDefaultMap"), Scenario.Map, GEngineIni);
+	}
+	if (Scenario.Frames <= 0 || Scenario.DeltaSeconds <= 0.f)
+	{
+		UE_LOG(LogTelekinesis, Error, TEXT("Scenario %s needs positive Frames and DeltaSeconds"), *ScenarioPath);
+		return 1;
+	}
+	// Play events in frame order, ties in the order they were written
+	Scenario.Events.StableSort([](const FTelekinesisSimEvent& A, const FTelekinesisSimEvent& B) { return A.Frame < B.Frame; });
+
+	UWorld* World = CreateSimWorld(Scenario.Map);
+	if (World == nullptr)
+	{
+		UE_LOG(LogTelekinesis, Error, TEXT("Couldn't load map %s"), *Scenario.Map);
+		return 1;
+	}
+
+	FMath::RandInit(Scenario.Seed);
+	FMath::SRandInit(Scenario.Seed);
+	if (UTelekinesisReplaySubsystem* ReplaySubsystem = World->GetSubsystem<UTelekinesisReplaySubsystem>())
+	{
+		ReplaySubsystem->SetRandomSeed(Scenario.Seed);
+	}
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(Scenario.DeltaSeconds);
+
+	ATelekinesisCharacter* Character = World->SpawnActor<ATelekinesisCharacter>(Scenario.CharacterLocation, FRotator::ZeroRotator);
+	TArray<ATelekineticActor*> Props;
+	TArray<AMiniTelekineticActor*> MiniProps;
+	SpawnPopulation(World, Scenario, Props, MiniProps);
+	UE_LOG(LogTelekinesis, Display, TEXT("Simulating %d props and %d mini props for %d frames of %.4fs"), Props.Num(), MiniProps.Num(), Scenario.Frames, Scenario.DeltaSeconds);
+
+	// Time physics from its own delegates, it runs inside the world tick
+	double PhysicsStartSeconds = 0.0;
+	double PhysicsSeconds = 0.0;
+	FPhysScene* PhysScene = World->GetPhysicsScene();
+	FDelegateHandle PreTickHandle;
+	FDelegateHandle PostTickHandle;
+	if (PhysScene != nullptr)
+	{
+		PreTickHandle = PhysScene->OnPhysScenePreTick.AddLambda([&PhysicsStartSeconds](FPhysScene*, float)
+		{
+			PhysicsStartSeconds = FPlatformTime::Seconds();
+		});
+		PostTickHandle = PhysScene->OnPhysScenePostTick.AddLambda([&PhysicsStartSeconds, &PhysicsSeconds](FPhysScene*)
+		{
+			PhysicsSeconds += FPlatformTime::Seconds() - PhysicsStartSeconds;
+		});
+	}
+
+	UTelekinesisWorldSubsystem* TelekinesisSubsystem = World->GetSubsystem<UTelekinesisWorldSubsystem>();
+	TArray<FSimFrame> Frames;
+	Frames.Reserve(Scenario.Frames);
+	int32 NextEvent = 0;
+	for (int32 FrameIndex = 0; FrameIndex < Scenario.Frames; ++FrameIndex)
+	{
+		while (NextEvent < Scenario.Events.Num() && Scenario.Events[NextEvent].Frame <= FrameIndex)
+		{
+			ApplyEvent(Scenario.Events[NextEvent++], Character, Props);
+		}
+
+		FApp::SetDeltaTime(Scenario.DeltaSeconds);
+		FApp::SetCurrentTime(FApp::GetCurrentTime() + Scenario.DeltaSeconds);
+		PhysicsSeconds = 0.0;
+		const double TickStartSeconds = FPlatformTime::Seconds();
+		World->Tick(LEVELTICK_All, Scenario.DeltaSeconds);
+		++GFrameCounter;
+
+		FSimFrame& Frame = Frames.AddDefaulted_GetRef();
+		Frame.WorldTickMs = (FPlatformTime::Seconds() - TickStartSeconds) * 1000.0;
+		Frame.PhysicsMs = PhysicsSeconds * 1000.0;
+		if (TelekinesisSubsystem != nullptr)
+		{
+			Frame.TelekinesisMs = TelekinesisSubsystem->ConsumeTickSeconds() * 1000.0;
+			Frame.Traces = TelekinesisSubsystem->ConsumeTraceCount();
+			Frame.Lifting = TelekinesisSubsystem->GetNumLifting();
+			Frame.Reaching = TelekinesisSubsystem->GetNumReaching();
+		}
+	}
+
+	if (PhysScene != nullptr)
+	{
+		PhysScene->OnPhysScenePreTick.Remove(PreTickHandle);
+		PhysScene->OnPhysScenePostTick.Remove(PostTickHandle);
+	}
+	const bool bWritten = WriteResults(OutputDir, FPaths::GetBaseFilename(ScenarioPath), Frames, Props, MiniProps);
+	DestroySimWorld(World);
+	return bWritten ? 0 : 1;
+}
+
+UWorld* UTelekinesisSimCommandlet::CreateSimWorld(const FString& MapName) const
+{
+	UPackage* Package = LoadPackage(nullptr, *FPackageName::ObjectPathToPackageName(MapName), LOAD_None);
+	UWorld* World = Package != nullptr ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+
+	// Set the world up as a game, without a renderer, audio or a game mode
+	World->WorldType = EWorldType::Game;
+	World->AddToRoot();
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	GWorld = World;
+	World->InitWorld(UWorld::InitializationValues()
+		.AllowAudioPlayback(false)
+		.RequiresHitProxies(false)
+		.CreateNavigation(false)
+		.CreateAISystem(false)
+		.ShouldSimulatePhysics(true)
+		.SetTransactional(false));
+	World->UpdateWorldComponents(true, false);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+	// Without a game mode nothing starts play on the level's actors, so do it ourselves
+	if (World->GetAuthGameMode() == nullptr)
+	{
+		World->GetWorldSettings()->NotifyBeginPlay();
+	}
+	return World;
+}
+
+void UTelekinesisSimCommandlet::DestroySimWorld(UWorld* World) const
+{
+	World->BeginTearingDown();
+	for (FActorIterator It(World); It; ++It)
+	{
+		It->RouteEndPlay(EEndPlayReason::Quit);
+	}
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+	GWorld = nullptr;
+}
+
+void UTelekinesisSimCommandlet::SpawnPopulation(UWorld* World, const FTelekinesisSimScenario& Scenario, TArray<ATelekineticActor*>& OutProps,
+	TArray<AMiniTelekineticActor*>& OutMiniProps) const
+{
+	UClass* PropClass = LoadClass<ATelekineticActor>(nullptr, *Scenario.PropClass);
+	UClass* MiniPropClass = Scenario.MiniPropClass.IsEmpty() ? nullptr : LoadClass<AMiniTelekineticActor>(nullptr, *Scenario.MiniPropClass);
+	if (PropClass == nullptr)
+	{
+		UE_LOG(LogTelekinesis, Error, TEXT("Couldn't load prop class %s"), *Scenario.PropClass);
+		return;
+	}
+
+	// The same grid as ATelekinesisStressTest, mini props scattered around each prop
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	for (int32 Row = 0; Row < Scenario.GridSize; ++Row)
+	{
+		for (int32 Column = 0; Column < Scenario.GridSize; ++Column)
+		{
+			const FVector Location = Scenario.GridOrigin + FVector(Row * Scenario.GridSpacing, Column * Scenario.GridSpacing, 0.f);
+			if (ATelekineticActor* Prop = World->SpawnActor<ATelekineticActor>(PropClass, Location, FRotator::ZeroRotator, SpawnParameters))
+			{
+				OutProps.Add(Prop);
+			}
+			if (MiniPropClass == nullptr)
+			{
+				continue;
+			}
+			for (int32 Index = 0; Index < Scenario.MiniPropsPerProp; ++Index)
+			{
+				const float Angle = 2.f * PI * Index / Scenario.MiniPropsPerProp;
+				const FVector Offset = FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f) * Scenario.GridSpacing * 0.3f;
+				if (AMiniTelekineticActor* MiniProp = World->SpawnActor<AMiniTelekineticActor>(MiniPropClass, Location + Offset, FRotator::ZeroRotator, SpawnParameters))
+				{
+					OutMiniProps.Add(MiniProp);
+				}
+			}
+		}
+	}
+}
+
+void UTelekinesisSimCommandlet::ApplyEvent(const FTelekinesisSimEvent& Event, ATelekinesisCharacter* Character, const TArray<ATelekineticActor*>& Props) const
+{
+	const auto ApplyToProp = [&](ATelekineticActor* Prop)
+	{
+		if (!IsValid(Prop))
+		{
+			return;
+		}
+		switch (Event.Action)
+		{
+		case ETelekinesisSimAction::Pull:
+			if (Character != nullptr && Prop->GetTelekinesisState() == ETelekinesisStates::Default)
+			{
+				Prop->Pull(Character);
+			}
+			break;
+		case ETelekinesisSimAction::Push:
+			if (Prop->GetTelekinesisState() == ETelekinesisStates::Pulled)
+			{
+				Prop->Push(Event.Target);
+			}
+			break;
+		case ETelekinesisSimAction::Drop:
+			if (Prop->GetTelekinesisState() != ETelekinesisStates::Default)
+			{
+				Prop->Drop();
+			}
+			break;
+		}
+	};
+
+	if (Event.Props.Num() == 0)
+	{
+		for (ATelekineticActor* Prop : Props)
+		{
+			ApplyToProp(Prop);
+		}
+		return;
+	}
+	for (const int32 Index : Event.Props)
+	{
+		if (Props.IsValidIndex(Index))
+		{
+			ApplyToProp(Props[Index]);
+		}
+		else
+		{
+			UE_LOG(LogTelekinesis, Warning, TEXT("Scenario event on frame %d uses prop %d, there are only %d"), Event.Frame, Index, Props.Num());
+		}
+	}
+}
+
+bool UTelekinesisSimCommandlet::WriteResults(const FString& OutputDir, const FString& ScenarioName, const TArray<FSimFrame>& Frames,
+	const TArray<ATelekineticActor*>& Props, const TArray<AMiniTelekineticActor*>& MiniProps) const
+{
+	FString FramesCsv = TEXT("Frame,WorldTickMs,PhysicsMs,TelekinesisMs,Traces,Lifting,Reaching\n");
+	for (int32 Index = 0; Index < Frames.Num(); ++Index)
+	{
+		const FSimFrame& Frame = Frames[Index];
+		FramesCsv += FString::Printf(TEXT("%d,%.3f,%.3f,%.3f,%d,%d,%d\n"), Index, Frame.WorldTickMs, Frame.PhysicsMs, Frame.TelekinesisMs,
+			Frame.Traces, Frame.Lifting, Frame.Reaching);
+	}
+
+	// Props that left the world are written without a location, so both runs still line up row for row
+	FString PositionsCsv = TEXT("Kind,Index,X,Y,Z\n");
+	const auto AddPosition = [&PositionsCsv](const TCHAR* Kind, int32 Index, const AActor* Actor)
+	{
+		if (IsValid(Actor))
+		{
+			const FVector Location = Actor->GetActorLocation();
+			PositionsCsv += FString::Printf(TEXT("%s,%d,%.3f,%.3f,%.3f\n"), Kind, Index, Location.X, Location.Y, Location.Z);
+		}
+		else
+		{
+			PositionsCsv += FString::Printf(TEXT("%s,%d,,,\n"), Kind, Index);
+		}
+	};
+	for (int32 Index = 0; Index < Props.Num(); ++Index)
+	{
+		AddPosition(TEXT("Prop"), Index, Props[Index]);
+	}
+	for (int32 Index = 0; Index < MiniProps.Num(); ++Index)
+	{
+		AddPosition(TEXT("MiniProp"), Index, MiniProps[Index]);
+	}
+
+	const FString FramesFilename = OutputDir / FString::Printf(TEXT("%s-Frames.csv"), *ScenarioName);
+	const FString PositionsFilename = OutputDir / FString::Printf(TEXT("%s-Positions.csv"), *ScenarioName);
+	if (!FFileHelper::SaveStringToFile(FramesCsv, *FramesFilename) || !FFileHelper::SaveStringToFile(PositionsCsv, *PositionsFilename))
+	{
+		UE_LOG(LogTelekinesis, Error, TEXT("Failed to write simulation results to %s"), *OutputDir);
+		return false;
+	}
+	UE_LOG(LogTelekinesis, Display, TEXT("Wrote %d frames to %s and final locations to %s"), Frames.Num(), *FramesFilename, *PositionsFilename);
+	return true;
+}
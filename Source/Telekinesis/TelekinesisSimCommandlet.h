@@ -0,0 +1,107 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TelekinesisSimCommandlet.generated.h"
+
+UENUM()
+enum class ETelekinesisSimAction : uint8
+{
+	Pull,
+	Push,
+	Drop
+};
+
+/** Something the scenario does to some of its props at the start of a frame */
+USTRUCT()
+struct FTelekinesisSimEvent
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 Frame = 0;
+	UPROPERTY()
+	ETelekinesisSimAction Action = ETelekinesisSimAction::Pull;
+	/** Indices into the prop grid, row by row. Empty means every prop */
+	UPROPERTY()
+	TArray<int32> Props;
+	/** Where a Push sends the props */
+	UPROPERTY()
+	FVector Target = FVector::ZeroVector;
+};
+
+/** A UTelekinesisSimCommandlet run, read from JSON with the same field names */
+USTRUCT()
+struct FTelekinesisSimScenario
+{
+	GENERATED_BODY()
+
+	/** Map to load, empty uses the game's default map */
+	UPROPERTY()
+	FString Map;
+	UPROPERTY()
+	int32 Frames = 600;
+	UPROPERTY()
+	float DeltaSeconds = 1.f / 60.f;
+	/** Seeds the global random stream and every prop's, so runs of one scenario can be compared */
+	UPROPERTY()
+	int32 Seed = 0;
+	UPROPERTY()
+	FString PropClass = TEXT("/Game/Blueprints/BP_TelekineticProp.BP_TelekineticProp_C");
+	UPROPERTY()
+	FString MiniPropClass = TEXT("/Game/Blueprints/BP_MiniTelekineticProp.BP_MiniTelekineticProp_C");
+	/** The character props are pulled towards */
+	UPROPERTY()
+	FVector CharacterLocation = FVector(0.f, 0.f, 200.f);
+	/** Corner of the square prop grid, which runs along +X and +Y */
+	UPROPERTY()
+	FVector GridOrigin = FVector(500.f, 0.f, 100.f);
+	UPROPERTY()
+	int32 GridSize = 10;
+	UPROPERTY()
+	float GridSpacing = 300.f;
+	UPROPERTY()
+	int32 MiniPropsPerProp = 4;
+	UPROPERTY()
+	TArray<FTelekinesisSimEvent> Events;
+};
+
+/**
+ * Runs the telekinesis mechanic headless, without a renderer or player, for offline perf and behaviour regressions.
+ * Loads a map, spawns a grid of props and mini props, plays a JSON FTelekinesisSimScenario's Pull/Push/Drop events
+ * against them while stepping the world at a fixed delta time, then writes per frame timings and every prop's final location.
+ * UnrealEditor-Cmd Telekinesis.uproject -run=TelekinesisSim -Scenario=Path/To/Scenario.json [-Out=Dir] -nullrhi -unattended
+ * Diff the Positions CSV of two runs to catch behaviour changes, the Frames CSV to catch perf changes.
+ */
+UCLASS()
+class TELEKINESIS_API UTelekinesisSimCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UTelekinesisSimCommandlet();
+
+	// UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// End of UCommandlet interface
+
+private:
+	struct FSimFrame
+	{
+		float WorldTickMs = 0.f;
+		float PhysicsMs = 0.f;
+		float TelekinesisMs = 0.f;
+		int32 Traces = 0;
+		int32 Lifting = 0;
+		int32 Reaching = 0;
+	};
+
+	UWorld* CreateSimWorld(const FString& MapName) const;
+	void DestroySimWorld(UWorld* World) const;
+	void SpawnPopulation(UWorld* World, const FTelekinesisSimScenario& Scenario, TArray<class ATelekineticActor*>& OutProps,
+		TArray<class AMiniTelekineticActor*>& OutMiniProps) const;
+	void ApplyEvent(const FTelekinesisSimEvent& Event, class ATelekinesisCharacter* Character, const TArray<ATelekineticActor*>& Props) const;
+	bool WriteResults(const FString& OutputDir, const FString& ScenarioName, const TArray<FSimFrame>& Frames,
+		const TArray<ATelekineticActor*>& Props, const TArray<AMiniTelekineticActor*>& MiniProps) const;
+
+};
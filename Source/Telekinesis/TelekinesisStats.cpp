@@ -0,0 +1,54 @@
+#include "TelekinesisStats.h"
+
+DEFINE_STAT(STAT_TelekinesisLift);
+DEFINE_STAT(STAT_TelekinesisReach);
+DEFINE_STAT(STAT_TelekinesisJitter);
+DEFINE_STAT(STAT_TelekinesisMiniPropAttraction);
+DEFINE_STAT(STAT_TelekinesisTargetTrace);
+DEFINE_STAT(STAT_TelekinesisHitHandling);
+DEFINE_STAT(STAT_TelekinesisTrajectory);
+
+DEFINE_STAT(STAT_TelekinesisPropsHeld);
+DEFINE_STAT(STAT_TelekinesisPropsPushed);
+DEFINE_STAT(STAT_TelekinesisAttractedMiniProps);
+DEFINE_STAT(STAT_TelekinesisTraces);
+
+UE_TRACE_CHANNEL_DEFINE(TelekinesisChannel);
+
+#if UE_TRACE_ENABLED
+UE_TRACE_EVENT_BEGIN(Telekinesis, PropState)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, PropId)
+	UE_TRACE_EVENT_FIELD(uint8, OldState)
+	UE_TRACE_EVENT_FIELD(uint8, NewState)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Telekinesis, PropForce)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, PropId)
+	UE_TRACE_EVENT_FIELD(uint8, Force)
+	UE_TRACE_EVENT_FIELD(float, Magnitude)
+UE_TRACE_EVENT_END()
+#endif
+
+void FTelekinesisTrace::OutputPropState(const UObject* Prop, uint8 OldState, uint8 NewState)
+{
+#if UE_TRACE_ENABLED
+	UE_TRACE_LOG(Telekinesis, PropState, TelekinesisChannel)
+		<< PropState.Cycle(FPlatformTime::Cycles64())
+		<< PropState.PropId(Prop->GetUniqueID())
+		<< PropState.OldState(OldState)
+		<< PropState.NewState(NewState);
+#endif
+}
+
+void FTelekinesisTrace::OutputPropForce(const UObject* Prop, ETelekinesisTraceForce Force, float Magnitude)
+{
+#if UE_TRACE_ENABLED
+	UE_TRACE_LOG(Telekinesis, PropForce, TelekinesisChannel)
+		<< PropForce.Cycle(FPlatformTime::Cycles64())
+		<< PropForce.PropId(Prop->GetUniqueID())
+		<< PropForce.Force(static_cast<uint8>(Force))
+		<< PropForce.Magnitude(Magnitude);
+#endif
+}
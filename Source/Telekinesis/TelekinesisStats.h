@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+
+/**
+ * Telekinesis profiling. "stat Telekinesis" shows where the mechanic's time goes and how many props it's working on,
+ * and the cycle counters also show up as CPU scopes in Unreal Insights.
+ * The Telekinesis trace channel adds every prop's state changes and the forces applied to it, e.g. for a headless capture:
+ * Telekinesis.uproject -game -nullrhi -unattended -trace=cpu,telekinesis -tracefile=Telekinesis.utrace -TelekinesisStressTest
+ */
+DECLARE_STATS_GROUP(TEXT("Telekinesis"), STATGROUP_Telekinesis, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Lift"), STAT_TelekinesisLift, STATGROUP_Telekinesis, TELEKINESIS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Reach"), STAT_TelekinesisReach, STATGROUP_Telekinesis, TELEKINESIS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Jitter"), STAT_TelekinesisJitter, STATGROUP_Telekinesis, TELEKINESIS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Mini Prop Attraction"), STAT_TelekinesisMiniPropAttraction, STATGROUP_Telekinesis, TELEKINESIS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Target Tracing"), STAT_TelekinesisTargetTrace, STATGROUP_Telekinesis, TELEKINESIS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Hit Handling"), STAT_TelekinesisHitHandling, STATGROUP_Telekinesis, TELEKINESIS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Trajectory Preview"), STAT_TelekinesisTrajectory, STATGROUP_Telekinesis, TELEKINESIS_API);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Props Held"), STAT_TelekinesisPropsHeld, STATGROUP_Telekinesis, TELEKINESIS_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Props Pushed"), STAT_TelekinesisPropsPushed, STATGROUP_Telekinesis, TELEKINESIS_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Attracted Mini Props"), STAT_TelekinesisAttractedMiniProps, STATGROUP_Telekinesis, TELEKINESIS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Traces"), STAT_TelekinesisTraces, STATGROUP_Telekinesis, TELEKINESIS_API);
+
+UE_TRACE_CHANNEL_EXTERN(TelekinesisChannel, TELEKINESIS_API);
+
+/** Forces we trace, see FTelekinesisTrace::OutputPropForce */
+enum class ETelekinesisTraceForce : uint8
+{
+	Reach,
+	Jitter,
+	Bounce
+};
+
+/** Writes Telekinesis channel events, these do nothing unless the channel is enabled */
+struct TELEKINESIS_API FTelekinesisTrace
+{
+	/** Check before working out anything only a trace event needs */
+	static FORCEINLINE bool IsEnabled()
+	{
+		return UE_TRACE_CHANNELEXPR_IS_ENABLED(TelekinesisChannel);
+	}
+	/** A prop changed ETelekinesisStates */
+	static void OutputPropState(const UObject* Prop, uint8 OldState, uint8 NewState);
+	/** A force was applied to a prop, Magnitude is the size of the impulse or velocity change */
+	static void OutputPropForce(const UObject* Prop, ETelekinesisTraceForce Force, float Magnitude);
+};
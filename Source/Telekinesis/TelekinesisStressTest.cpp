@@ -0,0 +1,350 @@
+#include "TelekinesisStressTest.h"
+#include "Telekinesis.h"
+#include "TelekinesisCharacter.h"
+#include "TelekinesisWorldSubsystem.h"
+#include "TelekineticActor.h"
+#include "TelekineticPropNetState.h"
+#include "TelekineticPropEntitySubsystem.h"
+#include "MiniTelekineticActor.h"
+#include "Camera/CameraComponent.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetworkObjectList.h"
+#include "GameFramework/Controller.h"
+#include "Kismet/GameplayStatics.h"
+#include "Kismet/KismetSystemLibrary.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "UObject/ConstructorHelpers.h"
+
+ATelekinesisStressTest::ATelekinesisStressTest()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	static ConstructorHelpers::FClassFinder<ATelekineticActor> PropBPClass(TEXT("/Game/Blueprints/BP_TelekineticProp"));
+	if (PropBPClass.Class != NULL)
+	{
+		PropClass = PropBPClass.Class;
+	}
+	static ConstructorHelpers::FClassFinder<AMiniTelekineticActor> MiniPropBPClass(TEXT("/Game/Blueprints/BP_MiniTelekineticProp"));
+	if (MiniPropBPClass.Class != NULL)
+	{
+		MiniPropClass = MiniPropBPClass.Class;
+	}
+}
+
+void ATelekinesisStressTest::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	FParse::Value(CommandLine, TEXT("TKStressGrid="), GridSize);
+	FParse::Value(CommandLine, TEXT("TKStressMiniProps="), MiniPropsPerProp);
+	FParse::Value(CommandLine, TEXT("TKStressCycles="), NumCycles);
+	FParse::Value(CommandLine, TEXT("TKStressIdleSeconds="), IdleSeconds);
+	bEntityProps |= FParse::Param(CommandLine, TEXT("TKStressEntities"));
+	GridSize = FMath::Max(GridSize, 1);
+	MiniPropsPerProp = FMath::Max(MiniPropsPerProp, 0);
+	NumCycles = FMath::Max(NumCycles, 1);
+
+	WorldTickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &ATelekinesisStressTest::OnWorldTickStart);
+	WorldPostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &ATelekinesisStressTest::OnWorldPostActorTick);
+	if (FPhysScene* PhysScene = GetWorld()->GetPhysicsScene())
+	{
+		PhysScenePreTickHandle = PhysScene->OnPhysScenePreTick.AddUObject(this, &ATelekinesisStressTest::OnPhysScenePreTick);
+		PhysScenePostTickHandle = PhysScene->OnPhysScenePostTick.AddUObject(this, &ATelekinesisStressTest::OnPhysScenePostTick);
+	}
+}
+
+void ATelekinesisStressTest::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FWorldDelegates::OnWorldTickStart.Remove(WorldTickStartHandle);
+	FWorldDelegates::OnWorldPostActorTick.Remove(WorldPostActorTickHandle);
+	if (FPhysScene* PhysScene = GetWorld()->GetPhysicsScene())
+	{
+		PhysScene->OnPhysScenePreTick.Remove(PhysScenePreTickHandle);
+		PhysScene->OnPhysScenePostTick.Remove(PhysScenePostTickHandle);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+void ATelekinesisStressTest::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+	PhaseSeconds += DeltaSeconds;
+
+	switch (Phase)
+	{
+	case EStressTestPhase::WaitForPlayer:
+		PlayerCharacter = Cast<ATelekinesisCharacter>(UGameplayStatics::GetPlayerCharacter(this, 0));
+		if (PlayerCharacter && PlayerCharacter->GetController())
+		{
+			SpawnProps();
+			if (GetNumTargets() > 0)
+			{
+				SetPhase(EStressTestPhase::Idle);
+			}
+			else
+			{
+				Finish();
+			}
+		}
+		break;
+
+	case EStressTestPhase::Idle:
+		// Nothing held or pushed yet, so these rows are what idle props cost
+		if (PhaseSeconds >= IdleSeconds)
+		{
+			SetPhase(EStressTestPhase::Aim);
+		}
+		break;
+
+	case EStressTestPhase::Aim:
+	{
+		// Props can be pushed out of the world, skip anything that's gone
+		const int32 PropIndex = CycleIndex % GetNumTargets();
+		FVector PropLocation;
+		if (!GetTargetLocation(PropIndex, PropLocation) || PhaseSeconds > AimTimeoutSeconds)
+		{
+			UE_LOG(LogTelekinesis, Warning, TEXT("Stress test couldn't target prop %d, skipping it"), PropIndex);
+			RemoveTarget(PropIndex);
+			if (GetNumTargets() == 0)
+			{
+				Finish();
+				break;
+			}
+			SetPhase(EStressTestPhase::Aim);
+			break;
+		}
+		AimAt(PropLocation);
+		// The character picks its target in its own Tick, so Pull once it agrees with us
+		if (IsTargeting(PropIndex))
+		{
+			PlayerCharacter->InputTelekinesis();
+			SetPhase(EStressTestPhase::Hold);
+		}
+		break;
+	}
+
+	case EStressTestPhase::Hold:
+		if (PhaseSeconds >= HoldSeconds)
+		{
+			PlayerCharacter->InputTelekinesis();
+			SetPhase(EStressTestPhase::Push);
+		}
+		break;
+
+	case EStressTestPhase::Push:
+		if (PhaseSeconds >= PushSeconds)
+		{
+			if (++CycleIndex >= NumCycles)
+			{
+				Finish();
+				break;
+			}
+			SetPhase(EStressTestPhase::Aim);
+		}
+		break;
+
+	case EStressTestPhase::Finished:
+		break;
+	}
+}
+
+void ATelekinesisStressTest::SpawnProps()
+{
+	if (PropClass == nullptr)
+	{
+		UE_LOG(LogTelekinesis, Error, TEXT("Stress test has no PropClass"));
+		return;
+	}
+
+	// Lay the grid out on the ground in front of the player, the mini props scattered around each prop
+	const FVector Forward = PlayerCharacter->GetActorForwardVector().GetSafeNormal2D();
+	const FVector Right = FVector::CrossProduct(FVector::UpVector, Forward);
+	const FVector Origin = PlayerCharacter->GetActorLocation() + Forward * GridDistance - Right * (GridSize - 1) * GridSpacing * 0.5f;
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	UTelekineticPropEntitySubsystem* EntitySubsystem = GetWorld()->GetSubsystem<UTelekineticPropEntitySubsystem>();
+	if (bEntityProps && (EntitySubsystem == nullptr || !EntitySubsystem->IsSupported()))
+	{
+		UE_LOG(LogTelekinesis, Warning, TEXT("Stress test can only spawn entity props in a standalone game, spawning actors"));
+		bEntityProps = false;
+	}
+	Props.Reserve(GridSize * GridSize);
+	for (int32 Row = 0; Row < GridSize; ++Row)
+	{
+		for (int32 Column = 0; Column < GridSize; ++Column)
+		{
+			const FVector Location = Origin + Forward * Row * GridSpacing + Right * Column * GridSpacing;
+			if (bEntityProps)
+			{
+				if (EntitySubsystem->AddProp(PropClass, FTransform(Location)).IsSet())
+				{
+					EntityLocations.Add(Location);
+				}
+			}
+			else if (ATelekineticActor* Prop = GetWorld()->SpawnActor<ATelekineticActor>(PropClass, Location, FRotator::ZeroRotator, SpawnParameters))
+			{
+				Props.Add(Prop);
+			}
+			if (MiniPropClass == nullptr)
+			{
+				continue;
+			}
+			for (int32 Index = 0; Index < MiniPropsPerProp; ++Index)
+			{
+				const float Angle = 2.f * PI * Index / MiniPropsPerProp;
+				const FVector Offset = (Forward * FMath::Cos(Angle) + Right * FMath::Sin(Angle)) * GridSpacing * 0.3f;
+				if (GetWorld()->SpawnActor<AMiniTelekineticActor>(MiniPropClass, Location + Offset, FRotator::ZeroRotator, SpawnParameters))
+				{
+					++NumMiniProps;
+				}
+			}
+		}
+	}
+	NumProps = GetNumTargets();
+	UE_LOG(LogTelekinesis, Log, TEXT("Stress test spawned %d %s props and %d mini props"), NumProps, bEntityProps ? TEXT("entity") : TEXT("actor"), NumMiniProps);
+}
+
+void ATelekinesisStressTest::SetPhase(EStressTestPhase NewPhase)
+{
+	Phase = NewPhase;
+	PhaseSeconds = 0.f;
+}
+
+int32 ATelekinesisStressTest::GetNumTargets() const
+{
+	return bEntityProps ? EntityLocations.Num() : Props.Num();
+}
+
+bool ATelekinesisStressTest::GetTargetLocation(int32 Index, FVector& OutLocation) const
+{
+	if (bEntityProps)
+	{
+		OutLocation = EntityLocations[Index];
+		return true;
+	}
+	if (!IsValid(Props[Index]))
+	{
+		return false;
+	}
+	OutLocation = Props[Index]->GetActorLocation();
+	return true;
+}
+
+bool ATelekinesisStressTest::IsTargeting(int32 Index) const
+{
+	if (!bEntityProps)
+	{
+		return PlayerCharacter->TelekineticTarget == Props[Index];
+	}
+	// Entities are promoted to a new actor when targeted, so go by where it is
+	const ATelekineticActor* Target = PlayerCharacter->TelekineticTarget;
+	return Target != nullptr && FVector::DistSquared(Target->GetActorLocation(), EntityLocations[Index]) < FMath::Square(GridSpacing * 0.5f);
+}
+
+void ATelekinesisStressTest::RemoveTarget(int32 Index)
+{
+	if (bEntityProps)
+	{
+		EntityLocations.RemoveAt(Index);
+	}
+	else
+	{
+		Props.RemoveAt(Index);
+	}
+}
+
+void ATelekinesisStressTest::AimAt(const FVector& Location) const
+{
+	const FVector CameraLocation = PlayerCharacter->GetFollowCamera()->GetComponentLocation();
+	PlayerCharacter->GetController()->SetControlRotation((Location - CameraLocation).Rotation());
+}
+
+void ATelekinesisStressTest::Finish()
+{
+	SetPhase(EStressTestPhase::Finished);
+	SetActorTickEnabled(false);
+
+	FString Csv = FString::Printf(TEXT("Frame,FrameMs,WorldTickMs,PhysicsMs,TelekinesisMs,Traces,Lifting,Reaching,NetBytes,AwakeProps,NetActiveActors,Entities,Idle,Props,MiniProps\n"));
+	for (int32 Index = 0; Index < Frames.Num(); ++Index)
+	{
+		const FStressTestFrame& Frame = Frames[Index];
+		Csv += FString::Printf(TEXT("%d,%.3f,%.3f,%.3f,%.3f,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n"), Index, Frame.FrameMs, Frame.WorldTickMs,
+			Frame.PhysicsMs, Frame.TelekinesisMs, Frame.Traces, Frame.Lifting, Frame.Reaching, Frame.NetBytes, Frame.AwakeProps, Frame.NetActiveActors,
+			Frame.Entities, Frame.bIdle ? 1 : 0, NumProps, NumMiniProps);
+	}
+	const FString Filename = FPaths::ProfilingDir() / TEXT("TelekinesisStressTest") / FString::Printf(TEXT("StressTest-%s.csv"), *FDateTime::Now().ToString());
+	if (FFileHelper::SaveStringToFile(Csv, *Filename))
+	{
+		UE_LOG(LogTelekinesis, Log, TEXT("Stress test wrote %d frames to %s"), Frames.Num(), *Filename);
+	}
+	else
+	{
+		UE_LOG(LogTelekinesis, Error, TEXT("Stress test failed to write %s"), *Filename);
+	}
+
+	if (bQuitWhenFinished)
+	{
+		UKismetSystemLibrary::QuitGame(this, nullptr, EQuitPreference::Quit, false);
+	}
+}
+
+void ATelekinesisStressTest::OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World == GetWorld())
+	{
+		WorldTickStartSeconds = FPlatformTime::Seconds();
+		PhysicsSeconds = 0.0;
+	}
+}
+
+void ATelekinesisStressTest::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld() || Phase == EStressTestPhase::WaitForPlayer || Phase == EStressTestPhase::Finished)
+	{
+		return;
+	}
+	UTelekinesisWorldSubsystem* Subsystem = World->GetSubsystem<UTelekinesisWorldSubsystem>();
+	if (Subsystem == nullptr)
+	{
+		return;
+	}
+	// The subsystem ticks after actors, so its time and traces are a frame behind the rest of the row
+	FStressTestFrame& Frame = Frames.AddDefaulted_GetRef();
+	Frame.bIdle = Phase == EStressTestPhase::Idle;
+	Frame.FrameMs = FApp::GetDeltaTime() * 1000.f;
+	Frame.WorldTickMs = (FPlatformTime::Seconds() - WorldTickStartSeconds) * 1000.0;
+	Frame.PhysicsMs = PhysicsSeconds * 1000.0;
+	Frame.TelekinesisMs = Subsystem->ConsumeTickSeconds() * 1000.0;
+	Frame.Traces = Subsystem->ConsumeTraceCount();
+	Frame.Lifting = Subsystem->GetNumLifting();
+	Frame.Reaching = Subsystem->GetNumReaching();
+	Frame.NetBytes = FMath::DivideAndRoundUp<int64>(FTelekineticPropNetState::ConsumeBitsSent(), 8);
+	for (const ATelekineticActor* Prop : Props)
+	{
+		if (IsValid(Prop) && Prop->NetDormancy == DORM_Awake)
+		{
+			++Frame.AwakeProps;
+		}
+	}
+	if (const UNetDriver* NetDriver = World->GetNetDriver())
+	{
+		Frame.NetActiveActors = NetDriver->GetNetworkObjectList().GetActiveObjects().Num();
+	}
+	if (const UTelekineticPropEntitySubsystem* EntitySubsystem = World->GetSubsystem<UTelekineticPropEntitySubsystem>())
+	{
+		Frame.Entities = EntitySubsystem->GetNumEntities();
+	}
+}
+
+void ATelekinesisStressTest::OnPhysScenePreTick(FPhysScene* PhysScene, float DeltaSeconds)
+{
+	PhysicsStartSeconds = FPlatformTime::Seconds();
+}
+
+void ATelekinesisStressTest::OnPhysScenePostTick(FPhysScene* PhysScene)
+{
+	PhysicsSeconds += FPlatformTime::Seconds() - PhysicsStartSeconds;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Physics/PhysicsInterfaceDeclares.h"
+#include "TelekinesisStressTest.generated.h"
+
+/**
+ * Spawns a grid of telekinetic props and mini props in front of the player, then repeatedly pulls and pushes them
+ * through ATelekinesisCharacter::InputTelekinesis without any player input, recording per frame timings to a CSV.
+ * Place one in a map, or run headless with: Telekinesis.uproject -game -nullrhi -unattended -TelekinesisStressTest
+ * Optional overrides: -TKStressGrid=N -TKStressMiniProps=N -TKStressCycles=N -TKStressIdleSeconds=N
+ * Add -TKStressEntities to spawn the props as Mass entities instead of actors. Compare the rows with Idle set of both runs at a few
+ * grid sizes to see how idle prop cost scales on each path.
+ * On a listen server it drives the host, and NetBytes is the prop state the server sent to its clients.
+ * Compare AwakeProps and NetActiveActors with the prop count to see replication cost follow the active props.
+ */
+UCLASS()
+class TELEKINESIS_API ATelekinesisStressTest : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ATelekinesisStressTest();
+	virtual void Tick(float DeltaSeconds) override;
+
+	/** Quit the game once the CSV has been written */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Stress Test")
+	bool bQuitWhenFinished = false;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	UPROPERTY(EditAnywhere, Category="Stress Test", meta=(AllowPrivateAccess = "true"))
+	TSubclassOf<class ATelekineticActor> PropClass;
+	UPROPERTY(EditAnywhere, Category="Stress Test", meta=(AllowPrivateAccess = "true"))
+	TSubclassOf<class AMiniTelekineticActor> MiniPropClass;
+	/** Props spawned along each side of the square grid */
+	UPROPERTY(EditAnywhere, Category="Stress Test", meta=(AllowPrivateAccess = "true", ClampMin=1))
+	int32 GridSize = 10;
+	UPROPERTY(EditAnywhere, Category="Stress Test", meta=(AllowPrivateAccess = "true"))
+	float GridSpacing = 300.f;
+	/** How far in front of the player the grid starts */
+	UPROPERTY(EditAnywhere, Category="Stress Test", meta=(AllowPrivateAccess = "true"))
+	float GridDistance = 800.f;
+	UPROPERTY(EditAnywhere, Category="Stress Test", meta=(AllowPrivateAccess = "true", ClampMin=0))
+	int32 MiniPropsPerProp = 4;
+	/** Spawn the grid as idle Mass entities, see UTelekineticPropEntitySubsystem. Standalone only */
+	UPROPERTY(EditAnywhere, Category="Stress Test", meta=(AllowPrivateAccess = "true"))
+	bool bEntityProps = false;
+	/** Seconds we record with every prop idle before the first Pull */
+	UPROPERTY(EditAnywhere, Category="Stress Test", meta=(AllowPrivateAccess = "true", ClampMin=0))
+	float IdleSeconds = 2.f;
+	/** Pull/Push cycles to run before writing the CSV */
+	UPROPERTY(EditAnywhere, Category="Stress Test", meta=(AllowPrivateAccess = "true", ClampMin=1))
+	int32 NumCycles = 20;
+	UPROPERTY(EditAnywhere, Category="Stress Test", meta=(AllowPrivateAccess = "true"))
+	float HoldSeconds = 1.5f;
+	UPROPERTY(EditAnywhere, Category="Stress Test", meta=(AllowPrivateAccess = "true"))
+	float PushSeconds = 1.f;
+	/** Move on to the next prop if we haven't managed to target this one within this many seconds */
+	UPROPERTY(EditAnywhere, Category="Stress Test", meta=(AllowPrivateAccess = "true"))
+	float AimTimeoutSeconds = 1.f;
+
+	enum class EStressTestPhase : uint8
+	{
+		WaitForPlayer,
+		Idle,
+		Aim,
+		Hold,
+		Push,
+		Finished
+	};
+
+	struct FStressTestFrame
+	{
+		float FrameMs = 0.f;
+		float WorldTickMs = 0.f;
+		float PhysicsMs = 0.f;
+		float TelekinesisMs = 0.f;
+		int32 Traces = 0;
+		int32 Lifting = 0;
+		int32 Reaching = 0;
+		/** Prop state replicated by the server this frame */
+		int32 NetBytes = 0;
+		/** Props that aren't net dormant, and every actor the net driver had to consider */
+		int32 AwakeProps = 0;
+		int32 NetActiveActors = 0;
+		/** Props that are Mass entities rather than actors */
+		int32 Entities = 0;
+		/** Recorded before the first Pull */
+		bool bIdle = false;
+	};
+
+	UPROPERTY()
+	class ATelekinesisCharacter* PlayerCharacter = nullptr;
+	UPROPERTY()
+	TArray<ATelekineticActor*> Props;
+	/** Where our entity props were spawned, they only become actors once the character targets them */
+	TArray<FVector> EntityLocations;
+	int32 NumProps = 0;
+	int32 NumMiniProps = 0;
+
+	EStressTestPhase Phase = EStressTestPhase::WaitForPlayer;
+	float PhaseSeconds = 0.f;
+	int32 CycleIndex = 0;
+
+	TArray<FStressTestFrame> Frames;
+	double WorldTickStartSeconds = 0.0;
+	double PhysicsStartSeconds = 0.0;
+	double PhysicsSeconds = 0.0;
+	FDelegateHandle WorldTickStartHandle;
+	FDelegateHandle WorldPostActorTickHandle;
+	FDelegateHandle PhysScenePreTickHandle;
+	FDelegateHandle PhysScenePostTickHandle;
+
+	void SpawnProps();
+	void SetPhase(EStressTestPhase NewPhase);
+	int32 GetNumTargets() const;
+	/** Returns false if the prop has gone */
+	bool GetTargetLocation(int32 Index, FVector& OutLocation) const;
+	bool IsTargeting(int32 Index) const;
+	void RemoveTarget(int32 Index);
+	void AimAt(const FVector& Location) const;
+	void Finish();
+
+	void OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+	void OnPhysScenePreTick(FPhysScene* PhysScene, float DeltaSeconds);
+	void OnPhysScenePostTick(FPhysScene* PhysScene);
+
+};
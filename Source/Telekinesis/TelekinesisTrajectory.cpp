@@ -0,0 +1,86 @@
+#include "TelekinesisTrajectory.h"
+
+void FTelekinesisTrajectoryBatch::Reset()
+{
+	LocationX.Reset();
+	LocationY.Reset();
+	LocationZ.Reset();
+	VelocityX.Reset();
+	VelocityY.Reset();
+	VelocityZ.Reset();
+	Scale.Reset();
+	DampingScale.Reset();
+	SampleX.Reset();
+	SampleY.Reset();
+	SampleZ.Reset();
+	NumSamples = 0;
+}
+
+void FTelekinesisTrajectoryBatch::AddLane(const FVector& Location, const FVector& Velocity, float InScale, float InDampingScale)
+{
+	LocationX.Add(Location.X);
+	LocationY.Add(Location.Y);
+	LocationZ.Add(Location.Z);
+	VelocityX.Add(Velocity.X);
+	VelocityY.Add(Velocity.Y);
+	VelocityZ.Add(Velocity.Z);
+	Scale.Add(InScale);
+	DampingScale.Add(InDampingScale);
+}
+
+void FTelekinesisTrajectoryBatch::Simulate(const FVector& Target, float StepTime, int32 NumSteps, int32 SampleInterval)
+{
+	const int32 NumLanes = GetNumLanes();
+	SampleInterval = FMath::Max(SampleInterval, 1);
+	SampleX.Reset(NumLanes * (NumSteps / SampleInterval + 1));
+	SampleY.Reset(SampleX.Max());
+	SampleZ.Reset(SampleX.Max());
+	NumSamples = 0;
+	AddSamples();
+	if (NumLanes == 0)
+	{
+		return;
+	}
+
+	const float TargetX = Target.X;
+	const float TargetY = Target.Y;
+	const float TargetZ = Target.Z;
+	float* RESTRICT PX = LocationX.GetData();
+	float* RESTRICT PY = LocationY.GetData();
+	float* RESTRICT PZ = LocationZ.GetData();
+	float* RESTRICT VX = VelocityX.GetData();
+	float* RESTRICT VY = VelocityY.GetData();
+	float* RESTRICT VZ = VelocityZ.GetData();
+	const float* RESTRICT S = Scale.GetData();
+	const float* RESTRICT D = DampingScale.GetData();
+	for (int32 Step = 1; Step <= NumSteps; ++Step)
+	{
+		for (int32 Lane = 0; Lane < NumLanes; ++Lane)
+		{
+			// Constant speed Reach, a unit vector towards the target (zero once we're on it) times Scale, see FTelekinesisReachKernel::GetImpulse
+			const float DX = TargetX - PX[Lane];
+			const float DY = TargetY - PY[Lane];
+			const float DZ = TargetZ - PZ[Lane];
+			const float SizeSquared = DX * DX + DY * DY + DZ * DZ;
+			const float ImpulseScale = SizeSquared > SMALL_NUMBER ? S[Lane] * FMath::InvSqrt(SizeSquared) : 0.f;
+			VX[Lane] = (VX[Lane] + DX * ImpulseScale) * D[Lane];
+			VY[Lane] = (VY[Lane] + DY * ImpulseScale) * D[Lane];
+			VZ[Lane] = (VZ[Lane] + DZ * ImpulseScale) * D[Lane];
+			PX[Lane] += VX[Lane] * StepTime;
+			PY[Lane] += VY[Lane] * StepTime;
+			PZ[Lane] += VZ[Lane] * StepTime;
+		}
+		if (Step % SampleInterval == 0)
+		{
+			AddSamples();
+		}
+	}
+}
+
+void FTelekinesisTrajectoryBatch::AddSamples()
+{
+	SampleX.Append(LocationX);
+	SampleY.Append(LocationY);
+	SampleZ.Append(LocationZ);
+	++NumSamples;
+}
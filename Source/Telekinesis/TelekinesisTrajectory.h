@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Predicts where props would go if they were pushed at a target now, for the trajectory preview.
+ * Each lane is one prop running the ReachPoint motion, the same steps as FTelekinesisReachKernel with constant speed:
+ * a velocity change of Scale towards the target, then linear damping, then a move, every ReachTimeStep.
+ * Lane state is kept as a structure of arrays and every step is one branch free loop over the lanes, so predicting a whole
+ * volley costs about the same as predicting one prop. Jitter and collisions aren't modelled, we sweep the samples for those.
+ */
+class TELEKINESIS_API FTelekinesisTrajectoryBatch
+{
+public:
+	/** Drop every lane, keeping our allocations */
+	void Reset();
+	/** Add a prop starting at Location and Velocity, see FTelekinesisReachKernel for Scale and DampingScale */
+	void AddLane(const FVector& Location, const FVector& Velocity, float Scale, float DampingScale);
+	/** Run every lane NumSteps steps of StepTime towards Target, sampling their locations every SampleInterval steps */
+	void Simulate(const FVector& Target, float StepTime, int32 NumSteps, int32 SampleInterval);
+
+	int32 GetNumLanes() const { return LocationX.Num(); }
+	/** Samples per lane from the last Simulate, the first is each lane's starting location */
+	int32 GetNumSamples() const { return NumSamples; }
+	FVector GetSample(int32 Lane, int32 Sample) const
+	{
+		const int32 Index = Sample * GetNumLanes() + Lane;
+		return FVector(SampleX[Index], SampleY[Index], SampleZ[Index]);
+	}
+
+private:
+	// Lane state, one entry per lane
+	TArray<float> LocationX;
+	TArray<float> LocationY;
+	TArray<float> LocationZ;
+	TArray<float> VelocityX;
+	TArray<float> VelocityY;
+	TArray<float> VelocityZ;
+	TArray<float> Scale;
+	TArray<float> DampingScale;
+
+	/** Sampled locations, every lane's first sample, then every lane's second, and so on */
+	TArray<float> SampleX;
+	TArray<float> SampleY;
+	TArray<float> SampleZ;
+	int32 NumSamples = 0;
+
+	void AddSamples();
+
+};
@@ -0,0 +1,553 @@
+#include "TelekinesisWorldSubsystem.h"
+#include "TelekineticActor.h"
+#include "TelekineticGeometryCollectionActor.h"
+#include "TelekinesisAsyncPhysics.h"
+#include "TelekineticPropArchetype.h"
+#include "Components/SphereComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "SignificanceManager.h"
+#include "NiagaraComponent.h"
+#include "NiagaraDataInterfaceArrayFunctionLibrary.h"
+#include "NiagaraFunctionLibrary.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+
+void UTelekinesisWorldSubsystem::Deinitialize()
+{
+	for (const FTelekinesisLiftState& State : Lifts)
+	{
+		State.Prop->LiftStateIndex = INDEX_NONE;
+	}
+	for (const FTelekinesisReachState& State : Reaches)
+	{
+		State.Prop->ReachStateIndex = INDEX_NONE;
+	}
+	Lifts.Empty();
+	Reaches.Empty();
+	PropGrid.Reset();
+	PropsWithPendingOverlaps.Empty();
+	PropsWithPendingHits.Empty();
+	PropsReconciling.Empty();
+	PropsSettling.Empty();
+	PropsFeedingParticles.Empty();
+	PropsFracturing.Empty();
+	FracturedProps.Empty();
+	SharedParticleComponents.Empty();
+	SharedParticleFeeds.Empty();
+	if (FPhysScene* PhysScene = GetWorld()->GetPhysicsScene())
+	{
+		PhysScene->OnPhysScenePreTick.Remove(PhysScenePreTickHandle);
+		if (SimCallback != nullptr)
+		{
+			PhysScene->GetSolver()->UnregisterAndFreeSimCallbackObject_External(SimCallback);
+		}
+	}
+	SimCallback = nullptr;
+	Super::Deinitialize();
+}
+
+void UTelekinesisWorldSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+	if (FPhysScene* PhysScene = InWorld.GetPhysicsScene())
+	{
+		PhysScenePreTickHandle = PhysScene->OnPhysScenePreTick.AddUObject(this, &UTelekinesisWorldSubsystem::OnPhysScenePreTick);
+	}
+}
+
+void UTelekinesisWorldSubsystem::OnPhysScenePreTick(FPhysScene* PhysScene, float DeltaTime)
+{
+	const double StartSeconds = FPlatformTime::Seconds();
+	for (int32 Index = Reaches.Num() - 1; Index >= 0; --Index)
+	{
+		FTelekinesisReachState& State = Reaches[Index];
+		if (State.bFixedStep)
+		{
+			State.Prop->FixedStepReach(State, DeltaTime);
+		}
+	}
+	TickSeconds += FPlatformTime::Seconds() - StartSeconds;
+}
+
+void UTelekinesisWorldSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	const double StartSeconds = FPlatformTime::Seconds();
+	UpdateSignificance();
+
+	// Blend client props towards the server first, so this frame's Reach starts from the corrected location
+	for (int32 Index = PropsReconciling.Num() - 1; Index >= 0; --Index)
+	{
+		if (PropsReconciling[Index]->Reconcile(DeltaTime))
+		{
+			PropsReconciling.RemoveAtSwap(Index, 1, false);
+		}
+	}
+
+	// Step Reach before Lift so a Reach started by a Lift waits a full step, same as the old timers
+	for (int32 Index = Reaches.Num() - 1; Index >= 0; --Index)
+	{
+		FTelekinesisReachState& State = Reaches[Index];
+		if (State.bFixedStep)
+		{
+			continue;
+		}
+		// The physics thread moves us, we just keep our VFX following
+		if (State.bAsyncPhysics)
+		{
+			++State.StepCount;
+			if (ATelekineticActor::IsSignificanceStep(State, State.Prop->GetSignificance().ParticleFeedInterval))
+			{
+				State.Prop->FeedParticleLocation();
+			}
+			continue;
+		}
+		State.StepAccumulator += DeltaTime;
+		while (State.StepAccumulator >= ReachTimeStep)
+		{
+			State.StepAccumulator -= ReachTimeStep;
+			State.Prop->Reach(State);
+		}
+	}
+
+	// Every Lift in this pass shares the same time, like timers fired in the same frame
+	const float CurrTimeSeconds = GetWorld()->GetTimeSeconds();
+	for (int32 Index = Lifts.Num() - 1; Index >= 0; --Index)
+	{
+		FTelekinesisLiftState& State = Lifts[Index];
+		State.StepAccumulator += DeltaTime;
+		bool bFinished = false;
+		while (!bFinished && State.StepAccumulator >= LiftTimeStep)
+		{
+			State.StepAccumulator -= LiftTimeStep;
+			bFinished = State.Prop->Lift(State, CurrTimeSeconds);
+		}
+		if (bFinished)
+		{
+			RemoveLiftAt(Index);
+		}
+	}
+
+	for (int32 Index = PropsSettling.Num() - 1; Index >= 0; --Index)
+	{
+		if (PropsSettling[Index]->Settle(DeltaTime))
+		{
+			PropsSettling.RemoveAtSwap(Index, 1, false);
+		}
+	}
+
+	// One hit per pushed prop, from all of this frame's contacts
+	for (ATelekineticActor* Prop : PropsWithPendingHits)
+	{
+		Prop->FlushPushHit();
+	}
+	PropsWithPendingHits.Reset();
+
+	// Apply overlaps last, so props that just started lifting count as Pulled
+	for (ATelekineticActor* Prop : PropsWithPendingOverlaps)
+	{
+		Prop->FlushMiniPropOverlaps();
+	}
+	PropsWithPendingOverlaps.Reset();
+
+	// After hits, so props that broke this frame fracture this frame if the budget allows
+	UpdateFractures(DeltaTime);
+	FlushParticleFeeds();
+	PostAsyncPhysicsInput();
+#if STATS
+	UpdateStats();
+#endif
+	TickSeconds += FPlatformTime::Seconds() - StartSeconds;
+}
+
+void UTelekinesisWorldSubsystem::UpdateFractures(float DeltaTime)
+{
+	// Fracturing removes the prop from everything, so take it out of line first
+	for (int32 Count = 0; Count < MaxFracturesPerFrame && PropsFracturing.Num() > 0; ++Count)
+	{
+		ATelekineticGeometryCollectionActor* Prop = PropsFracturing[0];
+		PropsFracturing.RemoveAt(0, 1, false);
+		Prop->Fracture();
+		if (Prop->IsFractured())
+		{
+			FracturedProps.Add(Prop);
+		}
+	}
+
+	if (FracturedProps.Num() > 0)
+	{
+		GetMiniPropAttractors(FragmentAttractors);
+		for (ATelekineticGeometryCollectionActor* Prop : FracturedProps)
+		{
+			Prop->UpdateFragments(DeltaTime, FragmentAttractors);
+		}
+	}
+}
+
+void UTelekinesisWorldSubsystem::UpdateSignificance()
+{
+	USignificanceManager* SignificanceManager = FSignificanceManagerModule::Get(GetWorld());
+	if (SignificanceManager == nullptr)
+	{
+		return;
+	}
+	// Every player's view, so a server scales props by the players around them too
+	SignificanceViewpoints.Reset();
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		if (const APlayerController* PlayerController = Iterator->Get())
+		{
+			FVector Location;
+			FRotator Rotation;
+			PlayerController->GetPlayerViewPoint(Location, Rotation);
+			SignificanceViewpoints.Emplace(Rotation, Location);
+		}
+	}
+	// Bucket changes are applied right away, through each prop's post significance function
+	SignificanceManager->Update(SignificanceViewpoints);
+}
+
+int32 UTelekinesisWorldSubsystem::ConsumeTraceCount()
+{
+	const int32 Count = NumTraces;
+	NumTraces = 0;
+	return Count;
+}
+
+double UTelekinesisWorldSubsystem::ConsumeTickSeconds()
+{
+	const double Seconds = TickSeconds;
+	TickSeconds = 0.0;
+	return Seconds;
+}
+
+TStatId UTelekinesisWorldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTelekinesisWorldSubsystem, STATGROUP_Tickables);
+}
+
+bool UTelekinesisWorldSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTelekinesisWorldSubsystem::StartLift(ATelekineticActor* Prop, const FVector& Start, float StartTimeSeconds, bool bAsyncPhysics)
+{
+	check(Prop);
+	StopLift(Prop);
+	if (bAsyncPhysics)
+	{
+		CreateSimCallback();
+	}
+	FTelekinesisLiftState State;
+	State.Prop = Prop;
+	State.Start = Start;
+	State.StartTimeSeconds = StartTimeSeconds;
+	State.bAsyncPhysics = bAsyncPhysics && SimCallback != nullptr;
+	Prop->LiftStateIndex = Lifts.Add(State);
+}
+
+void UTelekinesisWorldSubsystem::StopLift(ATelekineticActor* Prop)
+{
+	if (IsLifting(Prop))
+	{
+		RemoveLiftAt(Prop->LiftStateIndex);
+	}
+}
+
+bool UTelekinesisWorldSubsystem::IsLifting(const ATelekineticActor* Prop) const
+{
+	return Prop->LiftStateIndex != INDEX_NONE;
+}
+
+void UTelekinesisWorldSubsystem::StartReach(ATelekineticActor* Prop, const FVector& Target, bool bReachCharacter, int32 JitterFrameTime, bool bFixedStep, bool bAsyncPhysics)
+{
+	check(Prop);
+	StopReach(Prop);
+	if (bAsyncPhysics)
+	{
+		CreateSimCallback();
+	}
+	FTelekinesisReachState State;
+	State.Prop = Prop;
+	State.Target = Target;
+	State.bReachCharacter = bReachCharacter;
+	State.JitterFrameTime = JitterFrameTime;
+	State.bFixedStep = bFixedStep;
+	State.bAsyncPhysics = bAsyncPhysics && SimCallback != nullptr;
+	Prop->ReachStateIndex = Reaches.Add(State);
+}
+
+void UTelekinesisWorldSubsystem::StopReach(ATelekineticActor* Prop)
+{
+	if (IsReaching(Prop))
+	{
+		RemoveReachAt(Prop->ReachStateIndex);
+	}
+}
+
+bool UTelekinesisWorldSubsystem::IsReaching(const ATelekineticActor* Prop) const
+{
+	return Prop->ReachStateIndex != INDEX_NONE;
+}
+
+void UTelekinesisWorldSubsystem::RegisterProp(ATelekineticActor* Prop)
+{
+	check(Prop);
+	PropGrid.Add(Prop);
+}
+
+void UTelekinesisWorldSubsystem::UpdateProp(ATelekineticActor* Prop)
+{
+	PropGrid.Update(Prop);
+}
+
+void UTelekinesisWorldSubsystem::QueueOverlapFlush(ATelekineticActor* Prop)
+{
+	PropsWithPendingOverlaps.AddUnique(Prop);
+}
+
+void UTelekinesisWorldSubsystem::QueuePushHit(ATelekineticActor* Prop)
+{
+	PropsWithPendingHits.AddUnique(Prop);
+}
+
+void UTelekinesisWorldSubsystem::QueueParticleFeed(ATelekineticActor* Prop)
+{
+	PropsFeedingParticles.Add(Prop);
+}
+
+void UTelekinesisWorldSubsystem::FlushParticleFeeds()
+{
+	for (TPair<UNiagaraSystem*, FSharedParticleFeed>& Pair : SharedParticleFeeds)
+	{
+		Pair.Value.Locations.Reset();
+	}
+	for (ATelekineticActor* Prop : PropsFeedingParticles)
+	{
+		const bool bFedNatively = Prop->FlushParticleFeed();
+		const UTelekineticPropArchetype& Tuning = Prop->GetArchetype();
+		if (Tuning.SharedParticleSystem != nullptr)
+		{
+			FSharedParticleFeed& Feed = SharedParticleFeeds.FindOrAdd(Tuning.SharedParticleSystem);
+			Feed.LocationsParameter = Tuning.SharedParticleLocationsParameter;
+			Feed.Locations.Add(Prop->GetActorLocation());
+		}
+		// Props that haven't been set up for the native feed still go through Blueprint
+		else if (!bFedNatively)
+		{
+			Prop->FeedLocationToParticleSystem();
+		}
+	}
+	PropsFeedingParticles.Reset();
+
+	// Shared systems get every location in one write, an empty one clears the trails of props that stopped
+	for (const TPair<UNiagaraSystem*, FSharedParticleFeed>& Pair : SharedParticleFeeds)
+	{
+		UNiagaraComponent*& Component = SharedParticleComponents.FindOrAdd(Pair.Key);
+		if (Component == nullptr)
+		{
+			Component = UNiagaraFunctionLibrary::SpawnSystemAtLocation(GetWorld(), Pair.Key, FVector::ZeroVector, FRotator::ZeroRotator,
+				FVector::OneVector, false, true, ENCPoolMethod::None, false);
+			if (Component == nullptr)
+			{
+				continue;
+			}
+		}
+		UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayVector(Component, Pair.Value.LocationsParameter, Pair.Value.Locations);
+	}
+}
+
+void UTelekinesisWorldSubsystem::GetMiniPropAttractors(TArray<FSphere>& OutAttractors) const
+{
+	OutAttractors.Reset();
+	// Props lift before they reach, and do both for a moment in between
+	for (const FTelekinesisReachState& State : Reaches)
+	{
+		if (State.Prop->TelekinesisState == ETelekinesisStates::Pulled)
+		{
+			OutAttractors.Emplace(State.Prop->GetActorLocation(), State.Prop->AttractionField->GetScaledSphereRadius());
+		}
+	}
+	for (const FTelekinesisLiftState& State : Lifts)
+	{
+		if (State.Prop->TelekinesisState == ETelekinesisStates::Pulled && !IsReaching(State.Prop))
+		{
+			OutAttractors.Emplace(State.Prop->GetActorLocation(), State.Prop->AttractionField->GetScaledSphereRadius());
+		}
+	}
+}
+
+FTraceHandle UTelekinesisWorldSubsystem::AsyncSweepByObjectType(const FVector& Start, const FVector& End, const FCollisionShape& Shape,
+	const FCollisionObjectQueryParams& ObjectQueryParams, const FCollisionQueryParams& Params)
+{
+	CountTraces();
+	return GetWorld()->AsyncSweepByObjectType(EAsyncTraceType::Single, Start, End, FQuat::Identity, ObjectQueryParams, Shape, Params);
+}
+
+FTraceHandle UTelekinesisWorldSubsystem::AsyncSweepByChannel(const FVector& Start, const FVector& End, const FCollisionShape& Shape,
+	ECollisionChannel Channel, const FCollisionQueryParams& Params, const FCollisionResponseParams& ResponseParams)
+{
+	CountTraces();
+	return GetWorld()->AsyncSweepByChannel(EAsyncTraceType::Single, Start, End, FQuat::Identity, Channel, Shape, Params, ResponseParams);
+}
+
+FTraceHandle UTelekinesisWorldSubsystem::AsyncLineTraceByChannel(const FVector& Start, const FVector& End, ECollisionChannel Channel,
+	const FCollisionQueryParams& Params)
+{
+	CountTraces();
+	return GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, End, Channel, Params);
+}
+
+bool UTelekinesisWorldSubsystem::GetAsyncTraceResult(const FTraceHandle& Handle, FHitResult& OutHit) const
+{
+	FTraceDatum Datum;
+	if (!Handle.IsValid() || !GetWorld()->QueryTraceData(Handle, Datum))
+	{
+		return false;
+	}
+	// Single traces only return their blocking hit
+	OutHit = Datum.OutHits.Num() > 0 ? Datum.OutHits[0] : FHitResult();
+	return true;
+}
+
+void UTelekinesisWorldSubsystem::QueueReconcile(ATelekineticActor* Prop)
+{
+	PropsReconciling.AddUnique(Prop);
+}
+
+void UTelekinesisWorldSubsystem::QueueSettle(ATelekineticActor* Prop)
+{
+	PropsSettling.AddUnique(Prop);
+}
+
+void UTelekinesisWorldSubsystem::QueueFracture(ATelekineticGeometryCollectionActor* Prop)
+{
+	PropsFracturing.AddUnique(Prop);
+}
+
+void UTelekinesisWorldSubsystem::RemoveProp(ATelekineticActor* Prop)
+{
+	StopLift(Prop);
+	StopReach(Prop);
+	PropGrid.Remove(Prop);
+	PropsWithPendingOverlaps.RemoveSingleSwap(Prop, false);
+	PropsWithPendingHits.RemoveSingleSwap(Prop, false);
+	PropsReconciling.RemoveSingleSwap(Prop, false);
+	PropsSettling.RemoveSingleSwap(Prop, false);
+	PropsFeedingParticles.RemoveSingleSwap(Prop, false);
+	if (ATelekineticGeometryCollectionActor* GeometryCollectionProp = Cast<ATelekineticGeometryCollectionActor>(Prop))
+	{
+		PropsFracturing.RemoveSingle(GeometryCollectionProp);
+		FracturedProps.RemoveSingleSwap(GeometryCollectionProp, false);
+	}
+}
+
+void UTelekinesisWorldSubsystem::CreateSimCallback()
+{
+	if (SimCallback != nullptr)
+	{
+		return;
+	}
+	if (FPhysScene* PhysScene = GetWorld()->GetPhysicsScene())
+	{
+		SimCallback = PhysScene->GetSolver()->CreateAndRegisterSimCallbackObject_External<FTelekinesisSimCallback>();
+	}
+}
+
+void UTelekinesisWorldSubsystem::UpdateStats() const
+{
+	// Every held or pushed prop is lifting, reaching or both
+	int32 NumHeld = 0;
+	int32 NumPushed = 0;
+	int32 NumAttractedMiniProps = 0;
+	const auto CountProp = [&](const ATelekineticActor* Prop)
+	{
+		if (Prop->TelekinesisState == ETelekinesisStates::Pulled)
+		{
+			++NumHeld;
+			NumAttractedMiniProps += Prop->AttractedMiniProps.Num();
+		}
+		else if (Prop->TelekinesisState == ETelekinesisStates::Pushed)
+		{
+			++NumPushed;
+		}
+	};
+	for (const FTelekinesisReachState& State : Reaches)
+	{
+		CountProp(State.Prop);
+	}
+	for (const FTelekinesisLiftState& State : Lifts)
+	{
+		if (State.Prop->ReachStateIndex == INDEX_NONE)
+		{
+			CountProp(State.Prop);
+		}
+	}
+	SET_DWORD_STAT(STAT_TelekinesisPropsHeld, NumHeld);
+	SET_DWORD_STAT(STAT_TelekinesisPropsPushed, NumPushed);
+	SET_DWORD_STAT(STAT_TelekinesisAttractedMiniProps, NumAttractedMiniProps);
+}
+
+void UTelekinesisWorldSubsystem::PostAsyncPhysicsInput()
+{
+	if (SimCallback == nullptr)
+	{
+		return;
+	}
+	int32 NumAsyncProps = 0;
+	for (const FTelekinesisReachState& State : Reaches)
+	{
+		NumAsyncProps += State.bAsyncPhysics ? 1 : 0;
+	}
+	for (const FTelekinesisLiftState& State : Lifts)
+	{
+		NumAsyncProps += State.bAsyncPhysics ? 1 : 0;
+	}
+	// Nothing to post once the physics thread already knows we have no props
+	if (NumAsyncProps == 0 && bLastAsyncInputEmpty)
+	{
+		return;
+	}
+	bLastAsyncInputEmpty = NumAsyncProps == 0;
+
+	FTelekinesisAsyncInput* Input = SimCallback->GetProducerInputData_External();
+	Input->Reset();
+	// A prop can be lifting and reaching at once during the transition, post it once with both
+	for (const FTelekinesisReachState& State : Reaches)
+	{
+		if (State.bAsyncPhysics)
+		{
+			const FTelekinesisLiftState* LiftState = IsLifting(State.Prop) ? &Lifts[State.Prop->LiftStateIndex] : nullptr;
+			State.Prop->AddAsyncPhysicsInput(LiftState, &State, *Input);
+		}
+	}
+	for (const FTelekinesisLiftState& State : Lifts)
+	{
+		if (State.bAsyncPhysics && !IsReaching(State.Prop))
+		{
+			State.Prop->AddAsyncPhysicsInput(&State, nullptr, *Input);
+		}
+	}
+}
+
+void UTelekinesisWorldSubsystem::RemoveLiftAt(int32 Index)
+{
+	Lifts[Index].Prop->LiftStateIndex = INDEX_NONE;
+	Lifts.RemoveAtSwap(Index, 1, false);
+	// Fix up the index of the prop that was swapped into the hole
+	if (Lifts.IsValidIndex(Index))
+	{
+		Lifts[Index].Prop->LiftStateIndex = Index;
+	}
+}
+
+void UTelekinesisWorldSubsystem::RemoveReachAt(int32 Index)
+{
+	Reaches[Index].Prop->ReachStateIndex = INDEX_NONE;
+	Reaches.RemoveAtSwap(Index, 1, false);
+	// Fix up the index of the prop that was swapped into the hole
+	if (Reaches.IsValidIndex(Index))
+	{
+		Reaches[Index].Prop->ReachStateIndex = Index;
+	}
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Physics/PhysicsInterfaceDeclares.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TelekinesisStats.h"
+#include "TelekineticPropGrid.h"
+#include "WorldCollision.h"
+#include "TelekinesisWorldSubsystem.generated.h"
+
+/** State for a prop in its Lift phase */
+struct FTelekinesisLiftState
+{
+	class ATelekineticActor* Prop = nullptr;
+	float StartTimeSeconds = 0.f;
+	FVector Start = FVector::ZeroVector;
+	float StepAccumulator = 0.f;
+	/** How far through the Lift we are, handed to the physics thread when it moves us */
+	float Alpha = 0.f;
+	bool bAsyncPhysics = false;
+};
+
+/** State for a prop in its Reach phase, including its Jitter counters */
+struct FTelekinesisReachState
+{
+	class ATelekineticActor* Prop = nullptr;
+	FVector Target = FVector::ZeroVector;
+	bool bReachCharacter = false;
+	int32 JitterFrameTime = 0;
+	int32 JitterCounter = 0;
+	/** Reach updates so far, paces the work our significance lets us skip */
+	int32 StepCount = 0;
+	float StepAccumulator = 0.f;
+
+	// Fixed step integrator, only used when the prop asks for bFixedStepReach
+	bool bFixedStep = false;
+	bool bFixedStepInitialized = false;
+	FVector Location = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+	FVector ExpectedLocation = FVector::ZeroVector;
+
+	/** The physics thread applies our forces, see FTelekinesisSimCallback */
+	bool bAsyncPhysics = false;
+};
+
+/**
+ * Advances every lifted, held and pushed ATelekineticActor in one pass per frame.
+ * Replaces the per-actor looping timers so the cost of the mechanic stays flat per prop.
+ */
+UCLASS()
+class TELEKINESIS_API UTelekinesisWorldSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Step rate of the Lift phase, matches the old per-actor Lift timer */
+	static constexpr float LiftTimeStep = 0.016f;
+	/** Step rate of the Reach phase, matches the old per-actor Reach timer */
+	static constexpr float ReachTimeStep = 0.0167f;
+
+	// USubsystem interface
+	virtual void Deinitialize() override;
+	// End of USubsystem interface
+
+	// UWorldSubsystem interface
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	// End of UWorldSubsystem interface
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+	/** Lift phase */
+	void StartLift(ATelekineticActor* Prop, const FVector& Start, float StartTimeSeconds, bool bAsyncPhysics);
+	void StopLift(ATelekineticActor* Prop);
+	bool IsLifting(const ATelekineticActor* Prop) const;
+
+	/** Reach phase */
+	void StartReach(ATelekineticActor* Prop, const FVector& Target, bool bReachCharacter, int32 JitterFrameTime, bool bFixedStep, bool bAsyncPhysics);
+	void StopReach(ATelekineticActor* Prop);
+	bool IsReaching(const ATelekineticActor* Prop) const;
+
+	/** Track a prop in the prop grid so it can be found by target acquisition */
+	void RegisterProp(ATelekineticActor* Prop);
+	/** Called when a registered prop moves */
+	void UpdateProp(ATelekineticActor* Prop);
+	/** Have a prop's coalesced mini prop overlaps applied at the end of this frame */
+	void QueueOverlapFlush(ATelekineticActor* Prop);
+	/** Have a pushed prop's coalesced hits handled at the end of this frame */
+	void QueuePushHit(ATelekineticActor* Prop);
+	/** Have a prop's location written to its particle systems at the end of this frame, see ATelekineticActor::FeedParticleLocation */
+	void QueueParticleFeed(ATelekineticActor* Prop);
+	/** Have a client blend out a prop's error against the server over the next few frames */
+	void QueueReconcile(ATelekineticActor* Prop);
+	/** Have the server put a prop to net dormancy once it stops moving */
+	void QueueSettle(ATelekineticActor* Prop);
+	/** Have a prop broken into fragments, within this frame's fracture budget or in a later frame's */
+	void QueueFracture(class ATelekineticGeometryCollectionActor* Prop);
+	/** Remove a prop from every phase and the prop grid, e.g. when it leaves the world */
+	void RemoveProp(ATelekineticActor* Prop);
+	const FTelekineticPropGrid& GetPropGrid() const { return PropGrid; }
+	/** Center and AttractionField radius of every held prop, for things attracted to them without an overlap */
+	void GetMiniPropAttractors(TArray<FSphere>& OutAttractors) const;
+
+	/**
+	 * Async scene queries, run off the game thread and ready the frame after they're requested.
+	 * Keep the handle and read the result with GetAsyncTraceResult next frame, after that it expires.
+	 */
+	FTraceHandle AsyncSweepByObjectType(const FVector& Start, const FVector& End, const FCollisionShape& Shape,
+		const FCollisionObjectQueryParams& ObjectQueryParams, const FCollisionQueryParams& Params);
+	FTraceHandle AsyncSweepByChannel(const FVector& Start, const FVector& End, const FCollisionShape& Shape, ECollisionChannel Channel,
+		const FCollisionQueryParams& Params, const FCollisionResponseParams& ResponseParams);
+	FTraceHandle AsyncLineTraceByChannel(const FVector& Start, const FVector& End, ECollisionChannel Channel, const FCollisionQueryParams& Params);
+	/** Returns false if the query is still in flight or has expired, otherwise fills OutHit with its blocking hit, if any */
+	bool GetAsyncTraceResult(const FTraceHandle& Handle, FHitResult& OutHit) const;
+
+	/** Perf counters, read and reset once per frame by ATelekinesisStressTest */
+	void CountTraces(int32 Count = 1) { NumTraces += Count; INC_DWORD_STAT_BY(STAT_TelekinesisTraces, Count); }
+	int32 ConsumeTraceCount();
+	double ConsumeTickSeconds();
+	int32 GetNumLifting() const { return Lifts.Num(); }
+	int32 GetNumReaching() const { return Reaches.Num(); }
+
+	/** Props fractured per frame at most, the rest wait in line so a chain reaction can't spike one frame */
+	int32 MaxFracturesPerFrame = 2;
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	TArray<FTelekinesisLiftState> Lifts;
+	TArray<FTelekinesisReachState> Reaches;
+	FTelekineticPropGrid PropGrid;
+	TArray<ATelekineticActor*> PropsWithPendingOverlaps;
+	TArray<ATelekineticActor*> PropsWithPendingHits;
+	TArray<ATelekineticActor*> PropsReconciling;
+	TArray<ATelekineticActor*> PropsSettling;
+	TArray<ATelekineticActor*> PropsFeedingParticles;
+	/** Waiting for fracture budget, oldest first */
+	TArray<ATelekineticGeometryCollectionActor*> PropsFracturing;
+	/** Broken props whose fragments we attract and put to sleep */
+	TArray<ATelekineticGeometryCollectionActor*> FracturedProps;
+	/** Scratch for FracturedProps, see GetMiniPropAttractors */
+	TArray<FSphere> FragmentAttractors;
+	/** One component per UTelekineticPropArchetype::SharedParticleSystem, and the locations we feed it this frame */
+	UPROPERTY()
+	TMap<class UNiagaraSystem*, class UNiagaraComponent*> SharedParticleComponents;
+	struct FSharedParticleFeed
+	{
+		FName LocationsParameter;
+		TArray<FVector> Locations;
+	};
+	TMap<UNiagaraSystem*, FSharedParticleFeed> SharedParticleFeeds;
+	FDelegateHandle PhysScenePreTickHandle;
+	/** Created the first time a prop wants its forces run on the physics thread */
+	class FTelekinesisSimCallback* SimCallback = nullptr;
+	bool bLastAsyncInputEmpty = true;
+	TArray<FTransform> SignificanceViewpoints;
+	int32 NumTraces = 0;
+	double TickSeconds = 0.0;
+
+	/** Runs fixed step Reaches with the physics delta time, right before physics steps */
+	void OnPhysScenePreTick(FPhysScene* PhysScene, float DeltaTime);
+
+	/** Fracture queued props up to MaxFracturesPerFrame, then update every fractured prop's fragments */
+	void UpdateFractures(float DeltaTime);
+
+	/** Write every queued particle feed, once per prop and one array per shared system */
+	void FlushParticleFeeds();
+
+	/** Hand the players' views to the significance manager, which buckets every held and pushed prop */
+	void UpdateSignificance();
+	/** Set the STATGROUP_Telekinesis prop counts */
+	void UpdateStats() const;
+
+	void CreateSimCallback();
+	/** Hand this frame's targets and state to the physics thread */
+	void PostAsyncPhysicsInput();
+
+	void RemoveLiftAt(int32 Index);
+	void RemoveReachAt(int32 Index);
+
+};
@@ -1,220 +1,499 @@
 #include "TelekineticActor.h"
+#include "Telekinesis.h"
 #include "TelekinesisCharacter.h"
+#include "TelekinesisEffectsSubsystem.h"
+#include "TelekinesisReplaySubsystem.h"
+#include "TelekinesisWorldSubsystem.h"
+#include "TelekinesisAsyncPhysics.h"
+#include "TelekinesisReachKernel.h"
+#include "TelekinesisStats.h"
+#include "TelekineticPropArchetype.h"
+#include "TelekineticPropEntitySubsystem.h"
 #include "Components/SphereComponent.h"
-#include "Kismet/KismetMathLibrary.h"
 #include "Kismet/KismetSystemLibrary.h"
 #include "MiniTelekineticActor.h"
 #include "Components/AudioComponent.h"
 #include "Kismet/GameplayStatics.h"
+#include "Net/UnrealNetwork.h"
+#include "NiagaraComponent.h"
+#include "SignificanceManager.h"
 
 ATelekineticActor::ATelekineticActor()
 {
 	PrimaryActorTick.bCanEverTick = false;
 
-	// Setup Mesh and OnComponentHit callback
+	// We replicate our own compact state instead of our movement, see FTelekineticPropNetState
+	bReplicates = true;
+	SetReplicatingMovement(false);
+	NetUpdateFrequency = IdleNetUpdateFrequency;
+	// Idle props cost the net driver nothing, we wake up when we're pulled
+	NetDormancy = DORM_Initial;
+
+	// Setup Mesh and OnComponentHit callback, hit events are turned on while we're pushed
 	TelekineticMesh = CreateOptionalDefaultSubobject<UStaticMeshComponent>("Telekinetic Mesh");
 	if (TelekineticMesh)
 	{
 		SetRootComponent(TelekineticMesh);
 	}
 	TelekineticMesh->OnComponentHit.AddDynamic(this, &ATelekineticActor::OnHitCallback);
+	TelekineticMesh->SetNotifyRigidBodyCollision(false);
 
 	// Setup the Attraction Field for Mini Props
 	AttractionField = CreateDefaultSubobject<USphereComponent>("Attraction Field");
 	AttractionField->SetupAttachment(RootComponent);
-	//AttractionField->OnComponentBeginOverlap.AddDynamic(this, &ATelekineticActor::OnBeginOverlap);
-	//AttractionField->OnComponentEndOverlap.AddDynamic(this, &ATelekineticActor::OnEndOverlap);
+	AttractionField->OnComponentBeginOverlap.AddDynamic(this, &ATelekineticActor::OnBeginOverlap);
+	AttractionField->OnComponentEndOverlap.AddDynamic(this, &ATelekineticActor::OnEndOverlap);
+	// Only generate overlaps while we're pulled, idle props shouldn't cost the physics scene anything
+	AttractionField->SetGenerateOverlapEvents(false);
 
 	// AudioComponent for wind sound
 	AudioComponent = CreateDefaultSubobject<UAudioComponent>("Wind");
 	AudioComponent->SetupAttachment(RootComponent);
+
+}
+
+void ATelekineticActor::PostLoad()
+{
+	Super::PostLoad();
+	// Props saved before tuning moved into archetypes keep their overrides in one of their own. Blueprint instances
+	// pick up their class default object's, which loads first
+	if (Archetype == nullptr)
+	{
+		Archetype = UTelekineticPropArchetype::CreateFromDeprecatedProperties(this);
+	}
 }
 
 void ATelekineticActor::BeginPlay()
 {
 	Super::BeginPlay();
+	AttractedMiniProps.Init(GetArchetype().MaxAttractedMiniProps);
+	SeedRandomStream();
+	if (ParticleSystem == nullptr)
+	{
+		ParticleSystem = FindComponentByClass<UNiagaraComponent>();
+	}
+	// Keep our place in the prop grid up to date as we move
+	GetTelekinesisSubsystem()->RegisterProp(this);
+	TelekineticMesh->TransformUpdated.AddUObject(this, &ATelekineticActor::OnMeshTransformUpdated);
+	// Blueprints may have turned on Simulation Generates Hit Events
+	UpdateHitNotifies();
+	// Props placed in the map start dormant, spawned ones still have to reach clients once before they sleep
+	if (HasAuthority() && !IsNetStartupActor())
+	{
+		SetNetDormancy(DORM_DormantAll);
+	}
+	if (bIdleAsEntity)
+	{
+		if (UTelekineticPropEntitySubsystem* EntitySubsystem = GetWorld()->GetSubsystem<UTelekineticPropEntitySubsystem>())
+		{
+			EntitySubsystem->TrackProp(this);
+		}
+	}
+}
+
+void ATelekineticActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UTelekinesisWorldSubsystem* TelekinesisSubsystem = GetTelekinesisSubsystem())
+	{
+		TelekinesisSubsystem->RemoveProp(this);
+	}
+	SetSignificanceRegistered(false);
+	Super::EndPlay(EndPlayReason);
 }
 
 void ATelekineticActor::Pull(ATelekinesisCharacter* InPlayerCharacter)
 {
 	PlayerCharacter = InPlayerCharacter;
+	UpdateMassMultiplier();
+	SetTelekinesisState(ETelekinesisStates::Pulled);
 	StartLift();
 }
 
 void ATelekineticActor::StartLift()
 {
+	const UTelekineticPropArchetype& Tuning = GetArchetype();
 	Highlight(false);
-	LiftStart = GetActorLocation();
-	LiftStartTimeSeconds = GetWorld()->GetTimeSeconds();
-	GetWorldTimerManager().SetTimer(LiftTimerHandle, this, &ATelekineticActor::Lift, 0.016f, true);
+	GetTelekinesisSubsystem()->StartLift(this, GetActorLocation(), GetWorld()->GetTimeSeconds(), Tuning.bAsyncPhysicsForces);
 	ActivateParticleSystem();
-	// DetectMiniProps();
-	UGameplayStatics::PlaySound2D(GetWorld(), LiftSound);
+	SetNiagaraSpawnRate(Tuning.NiagaraSpawnRate * GetSignificance().NiagaraSpawnRateScale);
+	// Start capturing mini props, the ones we already overlap won't send a begin overlap
+	AttractionField->SetGenerateOverlapEvents(true);
+	DetectMiniProps();
+	PlayOneShotSound(Tuning.LiftSound);
 }
 
-void ATelekineticActor::Lift()
+bool ATelekineticActor::Lift(FTelekinesisLiftState& State, float CurrTimeSeconds)
 {
-	TelekinesisState = ETelekinesisStates::Pulled;
-
+	SCOPE_CYCLE_COUNTER(STAT_TelekinesisLift);
+	const UTelekineticPropArchetype& Tuning = GetArchetype();
 	// Determine our Alpha value
-	const float CurrTimeSeconds = GetWorld()->GetTimeSeconds();
-	const float Alpha = UKismetMathLibrary::MapRangeClamped(CurrTimeSeconds, LiftStartTimeSeconds, GetLiftEndTimeSeconds(), 0.f, 1.0f);
+	const float LiftEndTimeSeconds = GetLiftEndTimeSeconds(State.StartTimeSeconds);
+	const float Alpha = FTelekinesisReachKernel::GetLiftAlpha(CurrTimeSeconds, State.StartTimeSeconds, LiftEndTimeSeconds);
+	State.Alpha = Alpha;
 
 	// Move upwards, relative to our start location, equal to our LiftHeight
-	const float TargetHeight = LiftStart.Z + LiftHeight;
-	const float NewHeight = UKismetMathLibrary::Lerp(GetActorLocation().Z, TargetHeight, Alpha);
+	const float TargetHeight = State.Start.Z + Tuning.LiftHeight;
+	const float NewHeight = FTelekinesisReachKernel::GetLiftHeight(GetActorLocation().Z, TargetHeight, Alpha);
 	
 	// Start Reach before we're fully done for a smoother transition between the two phases
-	if (Alpha >= LiftReachTransitionPercent && !ReachTimerHandle.IsValid())
+	if (Alpha >= Tuning.LiftReachTransitionPercent && !GetTelekinesisSubsystem()->IsReaching(this))
 	{
 		// Reach our Player's TK Prop hold location
 		StartReach(true);
 	}
 	
 	// Finished, jump to end location
-	if (CurrTimeSeconds >= GetLiftEndTimeSeconds())
+	if (CurrTimeSeconds >= LiftEndTimeSeconds)
 	{
 		SetActorLocation(FVector(GetActorLocation().X, GetActorLocation().Y, TargetHeight));	
-		GetWorldTimerManager().ClearTimer(LiftTimerHandle);
-		LiftTimerHandle.Invalidate();
+		return true;
 	}
-	// Otherwise, Lerp from our current location to our target location
-	else
+	// Otherwise, Lerp from our current location to our target location, unless the physics thread does it for us
+	if (State.bAsyncPhysics)
 	{
-		SetActorLocation(FVector(GetActorLocation().X, GetActorLocation().Y, NewHeight));	
+		return false;
 	}
+	SetActorLocation(FVector(GetActorLocation().X, GetActorLocation().Y, NewHeight));
+	return false;
 }
 
 void ATelekineticActor::Push(FVector Destination)
 {
-	TelekinesisState = ETelekinesisStates::Pushed;
+	SetTelekinesisState(ETelekinesisStates::Pushed);
+	HoldSlot = INDEX_NONE;
+	PushDestination = Destination;
 	PushDirection = (Destination - GetActorLocation()).GetSafeNormal();
-	// Disable mini props collision so we don't collide with attracted mini props
-	for (const auto MiniProp : AttractedMiniProps)
-	{
-		MiniProp->GetMesh()->SetCollisionResponseToChannel(ECollisionChannel::ECC_GameTraceChannel1, ECollisionResponse::ECR_Ignore);
-	}
-	// Release all attracted mini props
-	AttractedMiniProps.Empty();
-	// Stop our Lift timer if that's active
-	if (LiftTimerHandle.IsValid())
-	{
-		GetWorldTimerManager().ClearTimer(LiftTimerHandle);
-		LiftTimerHandle.Invalidate();
-	}
-	// If our Reach timer has already begun, reset it with a new target
-	if (ReachTimerHandle.IsValid())
+	// Disable mini props collision so we don't collide with attracted mini props, unless another held prop still wants them
+	for (int32 Index = 0; Index < AttractedMiniProps.Num(); ++Index)
 	{
-		ClearReachTimer();
+		AMiniTelekineticActor* MiniProp = AttractedMiniProps.GetMiniProp(Index);
+		if (MiniProp != nullptr && MiniProp->GetNumAttractors() == 1)
+		{
+			MiniProp->GetMesh()->SetCollisionResponseToChannel(ECollisionChannel::ECC_GameTraceChannel1, ECollisionResponse::ECR_Ignore);
+		}
 	}
+	ReleaseMiniProps();
+	// Stop our Lift phase if that's active
+	GetTelekinesisSubsystem()->StopLift(this);
+	// If our Reach phase has already begun, reset it with a new target
+	ClearReach();
 	// Call reach with the passed-in destination
-	ReachTarget = Destination;
-	StartReach(false);
-	UGameplayStatics::PlaySound2D(GetWorld(), PushSound);
+	StartReach(false, Destination);
+	PlayOneShotSound(GetArchetype().PushSound);
 }
 
-void ATelekineticActor::StartReach(bool bReachCharacter)
+void ATelekineticActor::StartReach(bool bReachCharacter, const FVector& Target)
 {
+	const UTelekineticPropArchetype& Tuning = GetArchetype();
 	TelekineticMesh->SetEnableGravity(false);
-	TelekineticMesh->SetLinearDamping(20.0f);
-	JitterFrameTime = UKismetMathLibrary::RandomIntegerInRange(JitterFrameTimeRangeMin, JitterFrameTimeRangeMax);
+	// When we integrate Reach ourselves we also apply its damping, so don't let physics damp us twice
+	TelekineticMesh->SetLinearDamping(Tuning.bFixedStepReach || Tuning.bAsyncPhysicsForces ? 0.f : Tuning.ReachLinearDamping);
+	const int32 JitterFrameTime = RandomStream.RandRange(FMath::TruncToInt(Tuning.JitterFrameTimeRangeMin), FMath::TruncToInt(Tuning.JitterFrameTimeRangeMax));
+	AsyncJitterSeed = RandomStream.RandHelper(MAX_int32);
 	// Add a random angular impulse so the object isn't so static
-	const float ImpulseStrength = UKismetMathLibrary::RandomFloatInRange(LiftAngularImpulseMinStrength, LiftAngularImpulseMaxStrength);
-	const FVector AngularImpulse = UKismetMathLibrary::RandomUnitVector() * ImpulseStrength;
+	const float ImpulseStrength = RandomStream.FRandRange(Tuning.LiftAngularImpulseMinStrength, Tuning.LiftAngularImpulseMaxStrength);
+	const FVector AngularImpulse = RandomStream.VRand() * ImpulseStrength;
 	TelekineticMesh->AddAngularImpulseInDegrees(AngularImpulse, NAME_None, true);
 	// Reach Character or Target depending on boolean
-	if (bReachCharacter)
+	bWantsWindAudio = bReachCharacter;
+	UpdateWindAudio(true);
+	GetTelekinesisSubsystem()->StartReach(this, Target, bReachCharacter, JitterFrameTime, Tuning.bFixedStepReach && !Tuning.bAsyncPhysicsForces, Tuning.bAsyncPhysicsForces);
+}
+
+void ATelekineticActor::Reach(FTelekinesisReachState& State)
+{
+	if (State.bReachCharacter)
 	{
-		AudioComponent->Activate(true);
-		GetWorldTimerManager().SetTimer(ReachTimerHandle, this, &ATelekineticActor::ReachCharacter, 0.0167, true);
+		ReachCharacter(State);
 	}
 	else
 	{
-		AudioComponent->Deactivate();
-		GetWorldTimerManager().SetTimer(ReachTimerHandle, this, &ATelekineticActor::ReachPoint, 0.0167, true);
+		ReachPoint(State);
 	}
 }
 
-void ATelekineticActor::ReachCharacter()
+void ATelekineticActor::ReachCharacter(FTelekinesisReachState& State)
 {
 	if (PlayerCharacter == nullptr)
 	{
 		return;
 	}
-	ReachLocation(PlayerCharacter->GetTelekineticPropLocation(), PullSpeedMultiplier, false);
+	ReachLocation(State, PlayerCharacter->GetTelekineticPropLocation(HoldSlot), GetArchetype().PullSpeedMultiplier, false);
 }
 
-void ATelekineticActor::ReachPoint()
+void ATelekineticActor::ReachPoint(FTelekinesisReachState& State)
 {
-	ReachLocation(ReachTarget, PushSpeedMultiplier, true);
+	ReachLocation(State, State.Target, GetArchetype().PushSpeedMultiplier, true);
 }
 
-void ATelekineticActor::ReachLocation(const FVector& Location, float SpeedMultiplier, bool bConstantSpeed)
+void ATelekineticActor::ReachLocation(FTelekinesisReachState& State, const FVector& Location, float SpeedMultiplier, bool bConstantSpeed)
 {
-	FeedLocationToParticleSystem();
-	// Get the direction we want to move
-	FVector MoveDirection = Location - GetActorLocation();
-	// Pull at a constant rate, not based on distance
-	if (bConstantSpeed)
+	SCOPE_CYCLE_COUNTER(STAT_TelekinesisReach);
+	const FTelekinesisSignificanceBucket& Significance = GetSignificance();
+	++State.StepCount;
+	if (IsSignificanceStep(State, Significance.ParticleFeedInterval))
 	{
-		MoveDirection = MoveDirection.GetSafeNormal();
+		FeedParticleLocation();
 	}
-	// Make sure we don't pull/push too fast
-	MoveDirection = UKismetMathLibrary::ClampVectorSize(MoveDirection, 0.f, 1000.f);
-	// Lighter objects should move faster, heavier objects should move slower
-	MoveDirection *= UKismetMathLibrary::MapRangeClamped(
-		TelekineticMesh->GetMass(),
-		MassMinRange,
-		MassMaxRange,
-		MassMultiplierMaxRange,
-		MassMultiplierMinRange
-	);
-	// Add any additional speed multiplier we need
-	MoveDirection *= SpeedMultiplier;
 	// Add an impulse to our object to reach its destination
-	TelekineticMesh->AddImpulse(MoveDirection, NAME_None, true);
+	const FVector ReachImpulse = GetReachImpulse(GetActorLocation(), Location, SpeedMultiplier, bConstantSpeed);
+	TelekineticMesh->AddImpulse(ReachImpulse, NAME_None, true);
+	if (FTelekinesisTrace::IsEnabled())
+	{
+		FTelekinesisTrace::OutputPropForce(this, ETelekinesisTraceForce::Reach, ReachImpulse.Size());
+	}
 	// Jitter and attract MiniProps while an object is held
-	if (TelekinesisState == ETelekinesisStates::Pulled)
+	if (TelekinesisState == ETelekinesisStates::Pulled && IsSignificanceStep(State, Significance.PhysicsInterval))
+	{
+		const FVector JitterImpulse = Jitter(State, Significance.PhysicsInterval);
+		if (!JitterImpulse.IsZero())
+		{
+			TelekineticMesh->AddImpulse(JitterImpulse, NAME_None, true);
+		}
+		AttractMiniProps(Significance.PhysicsInterval);
+	}
+}
+
+void ATelekineticActor::FixedStepReach(FTelekinesisReachState& State, float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TelekinesisReach);
+	const UTelekineticPropArchetype& Tuning = GetArchetype();
+	if (DeltaTime <= 0.f || (State.bReachCharacter && PlayerCharacter == nullptr))
+	{
+		return;
+	}
+	const FVector ActorLocation = GetActorLocation();
+	if (!State.bFixedStepInitialized)
+	{
+		State.Location = ActorLocation;
+		State.Velocity = TelekineticMesh->GetPhysicsLinearVelocity();
+		State.bFixedStepInitialized = true;
+	}
+	else
+	{
+		// Keep anything physics did that we didn't integrate, e.g. a collision knocking us off course
+		State.Location += ActorLocation - State.ExpectedLocation;
+	}
+
+	const FVector Location = State.bReachCharacter ? PlayerCharacter->GetTelekineticPropLocation(HoldSlot) : State.Target;
+	const float SpeedMultiplier = State.bReachCharacter ? Tuning.PullSpeedMultiplier : Tuning.PushSpeedMultiplier;
+	const bool bConstantSpeed = !State.bReachCharacter;
+	const FTelekinesisSignificanceBucket& Significance = GetSignificance();
+	const bool bPulled = TelekinesisState == ETelekinesisStates::Pulled;
+	const float StepTime = UTelekinesisWorldSubsystem::ReachTimeStep;
+	// Same velocity change and damping per step as the impulse path at its nominal rate
+	const float StepDamping = FTelekinesisReachKernel::GetDampingScale(Tuning.ReachLinearDamping, StepTime);
+
+	// Significance intervals count fixed steps rather than frames, so Jitter lands on the same steps at any frame rate
+	bool bAnyPhysicsStep = false;
+	bool bAnyParticleFeedStep = false;
+	State.StepAccumulator = FMath::Min(State.StepAccumulator + DeltaTime, FMath::Max(Tuning.MaxReachSubsteps, 1) * StepTime);
+	while (State.StepAccumulator >= StepTime)
 	{
-		Jitter();
-		AttractMiniProps();
+		State.StepAccumulator -= StepTime;
+		++State.StepCount;
+		const bool bPhysicsStep = bPulled && IsSignificanceStep(State, Significance.PhysicsInterval);
+		bAnyPhysicsStep |= bPhysicsStep;
+		bAnyParticleFeedStep |= IsSignificanceStep(State, Significance.ParticleFeedInterval);
+		const FVector ReachImpulse = GetReachImpulse(State.Location, Location, SpeedMultiplier, bConstantSpeed);
+		State.Velocity += ReachImpulse;
+		if (FTelekinesisTrace::IsEnabled())
+		{
+			FTelekinesisTrace::OutputPropForce(this, ETelekinesisTraceForce::Reach, ReachImpulse.Size());
+		}
+		if (bPhysicsStep)
+		{
+			State.Velocity += Jitter(State, Significance.PhysicsInterval);
+		}
+		State.Velocity *= StepDamping;
+		State.Location += State.Velocity * StepTime;
+	}
+
+	// Drive the body onto our trajectory, extrapolating through the part of a step we haven't run yet
+	State.ExpectedLocation = State.Location + State.Velocity * State.StepAccumulator;
+	TelekineticMesh->SetPhysicsLinearVelocity((State.ExpectedLocation - ActorLocation) / DeltaTime);
+
+	if (bAnyParticleFeedStep)
+	{
+		FeedParticleLocation();
+	}
+	if (bAnyPhysicsStep)
+	{
+		AttractMiniProps(Significance.PhysicsInterval);
 	}
 }
 
-void ATelekineticActor::Jitter()
+FVector ATelekineticActor::GetReachImpulse(const FVector& From, const FVector& Location, float SpeedMultiplier, bool bConstantSpeed) const
 {
-	JitterCounter++;
-	if (JitterCounter < JitterFrameTime)
+	// Lighter objects should move faster, heavier objects should move slower
+	return FTelekinesisReachKernel::GetImpulse(From, Location, MassMultiplier * SpeedMultiplier, bConstantSpeed);
+}
+
+void ATelekineticActor::UpdateMassMultiplier()
+{
+	MassMultiplier = GetArchetype().GetMassMultiplier(TelekineticMesh->GetMass());
+}
+
+void ATelekineticActor::GetPushPrediction(FVector& OutLocation, FVector& OutVelocity, float& OutScale, float& OutDampingScale) const
+{
+	const UTelekineticPropArchetype& Tuning = GetArchetype();
+	OutLocation = GetActorLocation();
+	OutVelocity = TelekineticMesh->GetPhysicsLinearVelocity();
+	OutScale = MassMultiplier * Tuning.PushSpeedMultiplier;
+	OutDampingScale = FTelekinesisReachKernel::GetDampingScale(Tuning.ReachLinearDamping, UTelekinesisWorldSubsystem::ReachTimeStep);
+}
+
+void ATelekineticActor::SeedRandomStream()
+{
+	const UTelekinesisReplaySubsystem* ReplaySubsystem = GetWorld()->GetSubsystem<UTelekinesisReplaySubsystem>();
+	const uint32 SessionSeed = ReplaySubsystem ? ReplaySubsystem->GetRandomSeed() : 0;
+	RandomStream.Initialize(static_cast<int32>(HashCombine(SessionSeed, UTelekinesisReplaySubsystem::GetPropId(this))));
+}
+
+void ATelekineticActor::AddAsyncPhysicsInput(const FTelekinesisLiftState* LiftState, const FTelekinesisReachState* ReachState, FTelekinesisAsyncInput& Input) const
+{
+	const UTelekineticPropArchetype& Tuning = GetArchetype();
+	const FBodyInstance* BodyInstance = TelekineticMesh->GetBodyInstance();
+	if (BodyInstance == nullptr || !BodyInstance->IsValidBodyInstance())
+	{
+		return;
+	}
+	FTelekinesisAsyncProp& Prop = Input.Props.AddDefaulted_GetRef();
+	Prop.Proxy = BodyInstance->ActorHandle;
+
+	if (LiftState != nullptr)
+	{
+		Prop.bLift = true;
+		Prop.LiftTargetZ = LiftState->Start.Z + Tuning.LiftHeight;
+		Prop.LiftAlpha = LiftState->Alpha;
+		Prop.LiftAlphaPerSecond = Tuning.LiftDurationSeconds > 0.f ? 1.f / Tuning.LiftDurationSeconds : 1.f;
+	}
+
+	// Same as ReachCharacter, we can't reach a character we don't have
+	if (ReachState != nullptr && (!ReachState->bReachCharacter || PlayerCharacter != nullptr))
+	{
+		Prop.bReach = true;
+		Prop.Target = ReachState->bReachCharacter ? PlayerCharacter->GetTelekineticPropLocation(HoldSlot) : ReachState->Target;
+		Prop.SpeedMultiplier = ReachState->bReachCharacter ? Tuning.PullSpeedMultiplier : Tuning.PushSpeedMultiplier;
+		Prop.bConstantSpeed = !ReachState->bReachCharacter;
+		Prop.MassMultiplier = MassMultiplier;
+		Prop.LinearDamping = Tuning.ReachLinearDamping;
+	}
+
+	// Jitter and attract mini props while we're held
+	if (TelekinesisState != ETelekinesisStates::Pulled)
 	{
 		return;
 	}
-	JitterCounter = 0;
-	JitterFrameTime = UKismetMathLibrary::RandomIntegerInRange(JitterFrameTimeRangeMin, JitterFrameTimeRangeMax);
-	const int32 Strength = UKismetMathLibrary::RandomIntegerInRange(JitterStrengthMinMultiplier, JitterStrengthMaxMultiplier);
-	TelekineticMesh->AddImpulse(UKismetMathLibrary::RandomUnitVector() * Strength, NAME_None, true);
+	Prop.bJitter = true;
+	Prop.JitterFrameTimeMin = Tuning.JitterFrameTimeRangeMin;
+	Prop.JitterFrameTimeMax = Tuning.JitterFrameTimeRangeMax;
+	Prop.JitterStrengthMin = Tuning.JitterStrengthMinMultiplier;
+	Prop.JitterStrengthMax = Tuning.JitterStrengthMaxMultiplier;
+	Prop.JitterSeed = AsyncJitterSeed;
+	Prop.FirstMiniProp = Input.MiniProps.Num();
+	for (int32 Index = 0; Index < AttractedMiniProps.Num(); ++Index)
+	{
+		const FBodyInstance* MiniPropBody = AttractedMiniProps.GetBody(Index);
+		if (MiniPropBody != nullptr && MiniPropBody->IsValidBodyInstance())
+		{
+			FTelekinesisAsyncMiniProp& MiniProp = Input.MiniProps.AddDefaulted_GetRef();
+			MiniProp.Proxy = MiniPropBody->ActorHandle;
+			MiniProp.Strength = AttractedMiniProps.GetStrength(Index);
+		}
+	}
+	Prop.NumMiniProps = Input.MiniProps.Num() - Prop.FirstMiniProp;
+}
+
+FVector ATelekineticActor::Jitter(FTelekinesisReachState& State, int32 Steps)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TelekinesisJitter);
+	const UTelekineticPropArchetype& Tuning = GetArchetype();
+	State.JitterCounter += Steps;
+	if (State.JitterCounter < State.JitterFrameTime)
+	{
+		return FVector::ZeroVector;
+	}
+	State.JitterCounter = 0;
+	State.JitterFrameTime = RandomStream.RandRange(FMath::TruncToInt(Tuning.JitterFrameTimeRangeMin), FMath::TruncToInt(Tuning.JitterFrameTimeRangeMax));
+	const int32 Strength = RandomStream.RandRange(FMath::TruncToInt(Tuning.JitterStrengthMinMultiplier), FMath::TruncToInt(Tuning.JitterStrengthMaxMultiplier));
+	if (FTelekinesisTrace::IsEnabled())
+	{
+		FTelekinesisTrace::OutputPropForce(this, ETelekinesisTraceForce::Jitter, Strength);
+	}
+	return RandomStream.VRand() * Strength;
 }
 
 void ATelekineticActor::OnHitCallback(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp,
 	FVector NormalImpulse, const FHitResult& Hit)
 {
+	SCOPE_CYCLE_COUNTER(STAT_TelekinesisHitHandling);
 	if (TelekinesisState != ETelekinesisStates::Pushed)
 	{
 		return;
 	}
+	// Every contact of a step arrives separately, add them up and keep the strongest for one hit at the end of the frame
+	const float Impulse = NormalImpulse.Size();
+	PendingPushHitImpulse += Impulse;
+	if (!bPushHitQueued || Impulse > PendingPushHitStrongest)
+	{
+		PendingPushHit = Hit;
+		PendingPushHitStrongest = Impulse;
+	}
+	bPushHitQueued = true;
+	GetTelekinesisSubsystem()->QueuePushHit(this);
+}
+
+void ATelekineticActor::FlushPushHit()
+{
+	SCOPE_CYCLE_COUNTER(STAT_TelekinesisHitHandling);
+	const UTelekineticPropArchetype& Tuning = GetArchetype();
+	const FHitResult Hit = PendingPushHit;
+	const float Impulse = PendingPushHitImpulse;
+	bPushHitQueued = false;
+	PendingPushHitImpulse = 0.f;
+	PendingPushHitStrongest = 0.f;
+	if (TelekinesisState != ETelekinesisStates::Pushed || Impulse < Tuning.MinPushHitImpulse)
+	{
+		return;
+	}
+	HandlePushImpact(Hit, Impulse);
+}
+
+void ATelekineticActor::HandlePushImpact(const FHitResult& Hit, float Impulse)
+{
+	const UTelekineticPropArchetype& Tuning = GetArchetype();
 	// Deactivate the held particle system
 	DeactivateParticleSystem();
 	// Reset variables updated when we lift/reach
 	TelekineticMesh->SetEnableGravity(true);
 	TelekineticMesh->SetLinearDamping(0.1f);
-	TelekinesisState = ETelekinesisStates::Default;
-	ClearReachTimer();
+	SetTelekinesisState(ETelekinesisStates::Default);
+	ClearReach();
 	// Add our own slight bounce impulse
-	const FVector Reflection = UKismetMathLibrary::GetReflectionVector(PushDirection, Hit.ImpactNormal);
+	const FVector Reflection = FMath::GetReflectionVector(PushDirection, Hit.ImpactNormal);
 	// Reduce the physic's engine influence but attempt to keep the direction
 	TelekineticMesh->SetAllPhysicsLinearVelocity(FVector::ZeroVector);
-	TelekineticMesh->AddImpulse(Hit.ImpactPoint + (Reflection * CollisionBounciness));
-	// Spawn sparks particle system (blueprints)
-	SpawnSparks(-PushDirection);
+	const FVector BounceImpulse = Hit.ImpactPoint + (Reflection * Tuning.CollisionBounciness);
+	TelekineticMesh->AddImpulse(BounceImpulse);
+	if (FTelekinesisTrace::IsEnabled())
+	{
+		FTelekinesisTrace::OutputPropForce(this, ETelekinesisTraceForce::Bounce, BounceImpulse.Size());
+	}
+	// Spawn sparks, from the pool when we have a system, otherwise through blueprints
+	UTelekinesisEffectsSubsystem* EffectsSubsystem = GetWorld()->GetSubsystem<UTelekinesisEffectsSubsystem>();
+	if (EffectsSubsystem == nullptr)
+	{
+		SpawnSparks(-PushDirection);
+	}
+	else if (Tuning.SparksSystem)
+	{
+		EffectsSubsystem->SpawnSparks(this, Tuning.SparksSystem, Hit.ImpactPoint, -PushDirection, Tuning.SparksImpulseParameter);
+	}
+	else if (EffectsSubsystem->ConsumeSparksBudget(this))
+	{
+		SpawnSparks(-PushDirection);
+	}
 }
 
 void ATelekineticActor::Highlight(bool bHighlight)
@@ -222,36 +501,404 @@ void ATelekineticActor::Highlight(bool bHighlight)
 	TelekineticMesh->SetRenderCustomDepth(bHighlight);
 }
 
-float ATelekineticActor::GetLiftEndTimeSeconds() const
+void ATelekineticActor::OnMeshTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	if (UTelekinesisWorldSubsystem* TelekinesisSubsystem = GetTelekinesisSubsystem())
+	{
+		TelekinesisSubsystem->UpdateProp(this);
+	}
+}
+
+TObjectPtr<UStaticMeshComponent> ATelekineticActor::GetMesh() const
+{
+	return TelekineticMesh;
+}
+
+ETelekinesisStates ATelekineticActor::GetTelekinesisState() const
+{
+	return TelekinesisState;
+}
+
+void ATelekineticActor::SetHoldSlot(int32 InHoldSlot)
+{
+	HoldSlot = InHoldSlot;
+}
+
+bool ATelekineticActor::CanBePulledBy(const ATelekinesisCharacter* InPlayerCharacter) const
 {
-	return LiftStartTimeSeconds + LiftDurationSeconds;
+	return TelekinesisState != ETelekinesisStates::Pulled || PlayerCharacter == InPlayerCharacter;
 }
 
-void ATelekineticActor::ClearReachTimer()
+void ATelekineticActor::Drop()
 {
-	GetWorldTimerManager().ClearTimer(ReachTimerHandle);
-	ReachTimerHandle.Invalidate();
+	DeactivateParticleSystem();
+	bWantsWindAudio = false;
+	AudioComponent->Deactivate();
+	ReleaseMiniProps();
+	GetTelekinesisSubsystem()->StopLift(this);
+	ClearReach();
+	TelekineticMesh->SetEnableGravity(true);
+	TelekineticMesh->SetLinearDamping(0.1f);
+	PlayerCharacter = nullptr;
+	HoldSlot = INDEX_NONE;
+	SetTelekinesisState(ETelekinesisStates::Default);
 }
 
-void ATelekineticActor::AttractMiniProps()
+void ATelekineticActor::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
-	for (const auto MiniProp : AttractedMiniProps)
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	DOREPLIFETIME(ATelekineticActor, NetState);
+	DOREPLIFETIME(ATelekineticActor, PlayerCharacter);
+}
+
+void ATelekineticActor::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+	// Only called when the net driver considers us, so snapshotting here costs as often as NetUpdateFrequency allows
+	NetState.Location = GetActorLocation();
+	NetState.Rotation = GetActorRotation();
+	NetState.LinearVelocity = TelekineticMesh->GetPhysicsLinearVelocity();
+	NetState.State = TelekinesisState;
+	NetState.HoldSlot = HoldSlot;
+	NetState.PushDestination = PushDestination;
+}
+
+bool ATelekineticActor::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	if (bAlwaysRelevant || (PlayerCharacter != nullptr && PlayerCharacter == ViewTarget))
 	{
-		FVector Direction = (GetActorLocation() - MiniProp->GetActorLocation()).GetSafeNormal();
-		MiniProp->AttractForce(Direction);
+		return true;
 	}
+	// Relevant as far as the viewer can reach with telekinesis, plus some padding so props are there before they can be targeted
+	const ATelekinesisCharacter* ViewCharacter = Cast<ATelekinesisCharacter>(ViewTarget);
+	const float TelekinesisDistance = ViewCharacter != nullptr
+		? ViewCharacter->GetTelekinesisDistance()
+		: GetDefault<ATelekinesisCharacter>()->GetTelekinesisDistance();
+	return FVector::DistSquared(SrcLocation, GetActorLocation()) <= FMath::Square(TelekinesisDistance + NetRelevancyPadding);
 }
 
-void ATelekineticActor::OnBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
-                                       int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void ATelekineticActor::OnRep_NetState(const FTelekineticPropNetState& OldNetState)
 {
-	if (TelekinesisState != ETelekinesisStates::Pulled)
+	// Follow state changes we didn't predict ourselves, e.g. another player pulling or pushing us.
+	// Only move forwards through Pull and Push, so a late update can't undo something we've already predicted
+	if (NetState.State != OldNetState.State && NetState.State != TelekinesisState)
 	{
+		switch (NetState.State)
+		{
+		case ETelekinesisStates::Pulled:
+			if (TelekinesisState == ETelekinesisStates::Default && PlayerCharacter != nullptr)
+			{
+				Pull(PlayerCharacter);
+			}
+			break;
+		case ETelekinesisStates::Pushed:
+			if (TelekinesisState == ETelekinesisStates::Pulled)
+			{
+				Push(NetState.PushDestination);
+			}
+			break;
+		case ETelekinesisStates::Default:
+			Drop();
+			break;
+		}
+	}
+	if (NetState.State == ETelekinesisStates::Pulled)
+	{
+		HoldSlot = NetState.HoldSlot;
+	}
+	// Don't drag a prediction that's ahead of the server back to where the server last saw us
+	if (NetState.State == TelekinesisState)
+	{
+		StartReconcile();
+	}
+}
+
+void ATelekineticActor::StartReconcile()
+{
+	const FVector Error = NetState.Location - GetActorLocation();
+	if (Error.SizeSquared() > FMath::Square(ReconcileSnapDistance))
+	{
+		SetActorLocationAndRotation(NetState.Location, NetState.Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+		TelekineticMesh->SetPhysicsLinearVelocity(NetState.LinearVelocity);
+		ReconcileOffset = FVector::ZeroVector;
+		ReconcileRotationOffset = FQuat::Identity;
 		return;
 	}
+	ReconcileOffset = Error;
+	ReconcileRotationOffset = NetState.Rotation.Quaternion() * GetActorQuat().Inverse();
+	TelekineticMesh->SetPhysicsLinearVelocity(FMath::Lerp(TelekineticMesh->GetPhysicsLinearVelocity(), NetState.LinearVelocity, ReconcileVelocityBlend));
+	GetTelekinesisSubsystem()->QueueReconcile(this);
+}
+
+bool ATelekineticActor::Reconcile(float DeltaTime)
+{
+	const float Alpha = ReconcileSeconds > 0.f ? FMath::Min(DeltaTime / ReconcileSeconds, 1.f) : 1.f;
+	const FVector Step = ReconcileOffset * Alpha;
+	const FQuat RotationStep = FQuat::Slerp(FQuat::Identity, ReconcileRotationOffset, Alpha);
+	ReconcileOffset -= Step;
+	ReconcileRotationOffset = RotationStep.Inverse() * ReconcileRotationOffset;
+	// Teleport so physics keeps our velocity
+	SetActorLocationAndRotation(GetActorLocation() + Step, RotationStep * GetActorQuat(), false, nullptr, ETeleportType::TeleportPhysics);
+	return Alpha >= 1.f || ReconcileOffset.SizeSquared() < 1.f;
+}
+
+void ATelekineticActor::SetTelekinesisState(ETelekinesisStates NewState)
+{
+	if (TelekinesisState == NewState)
+	{
+		return;
+	}
+	if (FTelekinesisTrace::IsEnabled())
+	{
+		FTelekinesisTrace::OutputPropState(this, static_cast<uint8>(TelekinesisState), static_cast<uint8>(NewState));
+	}
+	if (UTelekinesisReplaySubsystem* ReplaySubsystem = GetWorld()->GetSubsystem<UTelekinesisReplaySubsystem>())
+	{
+		ReplaySubsystem->RecordPropState(this, NewState);
+	}
+	TelekinesisState = NewState;
+	UpdateHitNotifies();
+	// Only held and pushed props do anything worth scaling down
+	SetSignificanceRegistered(TelekinesisState != ETelekinesisStates::Default);
+	if (HasAuthority())
+	{
+		// Wake up as soon as we're pulled, and only go back to sleep once we've settled
+		if (TelekinesisState == ETelekinesisStates::Default)
+		{
+			SettledSeconds = 0.f;
+			GetTelekinesisSubsystem()->QueueSettle(this);
+		}
+		else if (NetDormancy != DORM_Awake)
+		{
+			SetNetDormancy(DORM_Awake);
+		}
+		UpdateNetUpdateFrequency();
+		ForceNetUpdate();
+	}
+}
+
+void ATelekineticActor::UpdateHitNotifies()
+{
+	const bool bNotify = TelekinesisState == ETelekinesisStates::Pushed;
+	if (TelekineticMesh->BodyInstance.bNotifyRigidBodyCollision != bNotify)
+	{
+		TelekineticMesh->SetNotifyRigidBodyCollision(bNotify);
+	}
+}
+
+bool ATelekineticActor::Settle(float DeltaTime)
+{
+	if (TelekinesisState != ETelekinesisStates::Default)
+	{
+		return true;
+	}
+	const bool bResting = !TelekineticMesh->IsAnyRigidBodyAwake()
+		|| TelekineticMesh->GetPhysicsLinearVelocity().SizeSquared() < FMath::Square(SettleSpeed);
+	SettledSeconds = bResting ? SettledSeconds + DeltaTime : 0.f;
+	if (SettledSeconds < SettleSeconds)
+	{
+		return false;
+	}
+	// The channel sends our final resting state before it goes dormant
+	ForceNetUpdate();
+	SetNetDormancy(DORM_DormantAll);
+	return true;
+}
+
+void ATelekineticActor::UpdateNetUpdateFrequency()
+{
+	if (TelekinesisState == ETelekinesisStates::Default)
+	{
+		NetUpdateFrequency = IdleNetUpdateFrequency;
+		return;
+	}
+	// Our updates are a fixed size per state, so the budget gives us an exact update rate
+	const float UpdateBytes = FTelekineticPropNetState::GetMaxNumBits(TelekinesisState) / 8.f;
+	NetUpdateFrequency = FMath::Max(IdleNetUpdateFrequency, ActiveNetBytesPerSecond / UpdateBytes);
+}
+
+float ATelekineticActor::GetLiftEndTimeSeconds(float LiftStartTimeSeconds) const
+{
+	return LiftStartTimeSeconds + GetArchetype().LiftDurationSeconds;
+}
+
+void ATelekineticActor::FeedParticleLocation()
+{
+	// However many Reach steps ask this frame, we only write once
+	if (!bParticleFeedQueued)
+	{
+		bParticleFeedQueued = true;
+		GetTelekinesisSubsystem()->QueueParticleFeed(this);
+	}
+}
+
+bool ATelekineticActor::FlushParticleFeed()
+{
+	const UTelekineticPropArchetype& Tuning = GetArchetype();
+	bParticleFeedQueued = false;
+	if (ParticleSystem == nullptr || Tuning.ParticleLocationParameter.IsNone())
+	{
+		return false;
+	}
+	ParticleSystem->SetVariableVec3(Tuning.ParticleLocationParameter, GetActorLocation());
+	return true;
+}
+
+void ATelekineticActor::SetSignificanceRegistered(bool bRegister)
+{
+	USignificanceManager* SignificanceManager = FSignificanceManagerModule::Get(GetWorld());
+	if (SignificanceManager == nullptr || bSignificanceRegistered == bRegister)
+	{
+		return;
+	}
+	bSignificanceRegistered = bRegister;
+	if (!bRegister)
+	{
+		SignificanceManager->UnregisterObject(this);
+		// Start at full fidelity next time we're pulled, until the significance manager says otherwise
+		SetSignificanceBucket(0);
+		return;
+	}
+	static const FName SignificanceTag(TEXT("TelekineticProp"));
+	SignificanceManager->RegisterObject(this, SignificanceTag,
+		[this](USignificanceManager::FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint)
+		{
+			return CalculateSignificance(Viewpoint);
+		},
+		USignificanceManager::EPostSignificanceType::Sequential,
+		[this](USignificanceManager::FManagedObjectInfo* ObjectInfo, float OldSignificance, float Significance, bool bFinal)
+		{
+			// Without buckets the score is still positive, and bucket 0 falls back to full fidelity in GetSignificance
+			const int32 Bucket = Significance > 0.f ? FMath::Max(GetArchetype().SignificanceBuckets.Num() - FMath::RoundToInt(Significance), 0) : INDEX_NONE;
+			SetSignificanceBucket(Bucket);
+		});
+}
+
+float ATelekineticActor::CalculateSignificance(const FTransform& Viewpoint) const
+{
+	const UTelekineticPropArchetype& Tuning = GetArchetype();
+	if (Tuning.SignificanceBuckets.Num() == 0)
+	{
+		// Never cull props that don't use buckets, see GetSignificance
+		return 1.f;
+	}
+	// Called off the game thread, so only read our location
+	const FVector ToProp = GetActorLocation() - Viewpoint.GetLocation();
+	const float DistanceSquared = ToProp.SizeSquared();
+	for (int32 Index = 0; Index < Tuning.SignificanceBuckets.Num(); ++Index)
+	{
+		if (DistanceSquared > FMath::Square(Tuning.SignificanceBuckets[Index].MaxDistance))
+		{
+			continue;
+		}
+		// Props right around the viewer keep full fidelity even when they're behind the camera
+		const float ViewDot = FVector::DotProduct(ToProp, Viewpoint.GetRotation().GetForwardVector());
+		if (Index > 0 && ViewDot < FMath::Cos(FMath::DegreesToRadians(Tuning.SignificanceViewAngle)) * FMath::Sqrt(DistanceSquared))
+		{
+			return 0.f;
+		}
+		return Tuning.SignificanceBuckets.Num() - Index;
+	}
+	return 0.f;
+}
+
+void ATelekineticActor::SetSignificanceBucket(int32 Bucket)
+{
+	if (SignificanceBucket == Bucket)
+	{
+		return;
+	}
+	SignificanceBucket = Bucket;
+	UpdateWindAudio(false);
+	if (TelekinesisState != ETelekinesisStates::Default)
+	{
+		SetNiagaraSpawnRate(GetArchetype().NiagaraSpawnRate * GetSignificance().NiagaraSpawnRateScale);
+	}
+}
+
+const FTelekinesisSignificanceBucket& ATelekineticActor::GetSignificance() const
+{
+	const UTelekineticPropArchetype& Tuning = GetArchetype();
+	if (SignificanceBucket == INDEX_NONE)
+	{
+		return Tuning.CulledSignificance;
+	}
+	// No buckets means we always run at full fidelity
+	static const FTelekinesisSignificanceBucket FullSignificance;
+	return Tuning.SignificanceBuckets.IsValidIndex(SignificanceBucket) ? Tuning.SignificanceBuckets[SignificanceBucket] : FullSignificance;
+}
+
+bool ATelekineticActor::IsSignificanceStep(const FTelekinesisReachState& State, int32 Interval)
+{
+	return Interval > 0 && State.StepCount % Interval == 0;
+}
+
+void ATelekineticActor::UpdateWindAudio(bool bRestart)
+{
+	if (!bWantsWindAudio || !GetSignificance().bAudio)
+	{
+		AudioComponent->Deactivate();
+	}
+	else if (bRestart || !AudioComponent->IsActive())
+	{
+		AudioComponent->Activate(true);
+	}
+}
+
+void ATelekineticActor::ClearReach()
+{
+	GetTelekinesisSubsystem()->StopReach(this);
+}
+
+const UTelekineticPropArchetype& ATelekineticActor::GetArchetype() const
+{
+	return Archetype != nullptr ? *Archetype : *GetDefault<UTelekineticPropArchetype>();
+}
+
+void ATelekineticActor::SetArchetype(UTelekineticPropArchetype* NewArchetype)
+{
+	Archetype = NewArchetype;
+	UpdateMassMultiplier();
+	// Our mini prop storage is sized by the archetype, it can only be resized while it's empty
+	if (AttractedMiniProps.Num() == 0)
+	{
+		AttractedMiniProps.Init(GetArchetype().MaxAttractedMiniProps);
+	}
+	if (TelekinesisState != ETelekinesisStates::Default)
+	{
+		SetNiagaraSpawnRate(GetArchetype().NiagaraSpawnRate * GetSignificance().NiagaraSpawnRateScale);
+	}
+}
+
+UTelekinesisWorldSubsystem* ATelekineticActor::GetTelekinesisSubsystem() const
+{
+	return GetWorld()->GetSubsystem<UTelekinesisWorldSubsystem>();
+}
+
+void ATelekineticActor::PlayOneShotSound(USoundBase* Sound)
+{
+	if (UTelekinesisEffectsSubsystem* EffectsSubsystem = GetWorld()->GetSubsystem<UTelekinesisEffectsSubsystem>())
+	{
+		EffectsSubsystem->PlaySound2D(this, Sound);
+	}
+	else
+	{
+		UGameplayStatics::PlaySound2D(GetWorld(), Sound);
+	}
+}
+
+void ATelekineticActor::AttractMiniProps(float StrengthScale)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TelekinesisMiniPropAttraction);
+	AttractedMiniProps.Attract(GetActorLocation(), StrengthScale);
+}
+
+void ATelekineticActor::OnBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
+                                       int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+{
 	if (AMiniTelekineticActor* MiniProp = Cast<AMiniTelekineticActor>(OtherActor))
 	{
-		AddMiniProp(MiniProp);
+		QueueMiniPropOverlap(MiniProp, true);
 	}
 }
 
@@ -260,10 +907,37 @@ void ATelekineticActor::OnEndOverlap(UPrimitiveComponent* OverlappedComponent, A
 {
 	if (AMiniTelekineticActor* MiniProp = Cast<AMiniTelekineticActor>(OtherActor))
 	{
-		RemoveMiniProp(MiniProp);
+		QueueMiniPropOverlap(MiniProp, false);
 	}
 }
 
+void ATelekineticActor::QueueMiniPropOverlap(AMiniTelekineticActor* MiniProp, bool bOverlapping)
+{
+	const bool bFirstEvent = bOverlapping ? MiniPropOverlaps.BeginOverlap(MiniProp) : MiniPropOverlaps.EndOverlap(MiniProp);
+	// Ask to be flushed once per frame, on our first event
+	if (bFirstEvent)
+	{
+		GetTelekinesisSubsystem()->QueueOverlapFlush(this);
+	}
+}
+
+void ATelekineticActor::FlushMiniPropOverlaps()
+{
+	MiniPropOverlaps.Flush([this](AMiniTelekineticActor* MiniProp, bool bOverlapping)
+	{
+		// Mini props being destroyed end their overlap too, those still have to come out of our buffer
+		if (!bOverlapping || !IsValid(MiniProp))
+		{
+			RemoveMiniProp(MiniProp);
+		}
+		// Only capture mini props while we're held
+		else if (TelekinesisState == ETelekinesisStates::Pulled)
+		{
+			AddMiniProp(MiniProp);
+		}
+	});
+}
+
 // Detect any MiniProps that are in the immediate radius of a Lifted object
 void ATelekineticActor::DetectMiniProps()
 {
@@ -276,6 +950,7 @@ void ATelekineticActor::DetectMiniProps()
 	ObjectTypes.Add(ObjectTypeQuery2);
 
 	// Perform the trace
+	GetTelekinesisSubsystem()->CountTraces();
 	UKismetSystemLibrary::SphereTraceMultiForObjects(
 		GetWorld(),
 		GetActorLocation(),
@@ -291,7 +966,7 @@ void ATelekineticActor::DetectMiniProps()
 		FLinearColor::Green
 	);
 
-	// Add any hit mini props to the attracted mini props array
+	// Treat any hit mini props like they've just started overlapping us
 	for (auto Hit : HitResults)
 	{
 		AMiniTelekineticActor* MiniProp = Cast<AMiniTelekineticActor>(Hit.GetActor());
@@ -299,24 +974,43 @@ void ATelekineticActor::DetectMiniProps()
 		{
 			continue;
 		}
-		AddMiniProp(MiniProp);
+		QueueMiniPropOverlap(MiniProp, true);
 	}
 }
 
 void ATelekineticActor::AddMiniProp(AMiniTelekineticActor* MiniProp)
 {
-	UE_LOG(LogTemp, Warning, TEXT("AddMiniProp!"));
-	AttractedMiniProps.Add(MiniProp);
-	MiniProp->GetMesh()->SetEnableGravity(false);
-	MiniProp->GetMesh()->SetLinearDamping(10.f);
+	if (!AttractedMiniProps.Add(MiniProp))
+	{
+		return;
+	}
+	UE_LOG(LogTelekinesis, Verbose, TEXT("%s attracting %s"), *GetName(), *MiniProp->GetName());
+	MiniProp->BeginAttraction();
 	// Make sure MiniProps collide with the held object
 	MiniProp->GetMesh()->SetCollisionResponseToChannel(ECollisionChannel::ECC_GameTraceChannel1, ECollisionResponse::ECR_Block);
 }
 
 void ATelekineticActor::RemoveMiniProp(AMiniTelekineticActor* MiniProp)
 {
-	UE_LOG(LogTemp, Warning, TEXT("RemoveMiniProp!"));
-	AttractedMiniProps.Remove(MiniProp);
-	MiniProp->GetMesh()->SetEnableGravity(true);
-	MiniProp->GetMesh()->SetLinearDamping(0.01f);
+	if (!AttractedMiniProps.Remove(MiniProp) || !IsValid(MiniProp))
+	{
+		return;
+	}
+	UE_LOG(LogTelekinesis, Verbose, TEXT("%s released %s"), *GetName(), *MiniProp->GetName());
+	MiniProp->EndAttraction();
+}
+
+void ATelekineticActor::ReleaseMiniProps()
+{
+	// We stop generating overlaps below so we won't get an end overlap to release them later
+	for (int32 Index = 0; Index < AttractedMiniProps.Num(); ++Index)
+	{
+		if (AMiniTelekineticActor* MiniProp = AttractedMiniProps.GetMiniProp(Index))
+		{
+			MiniProp->EndAttraction();
+		}
+	}
+	AttractedMiniProps.Reset();
+	AttractionField->SetGenerateOverlapEvents(false);
+	MiniPropOverlaps.Reset();
 }
\ No newline at end of file
@@ -3,6 +3,10 @@
 #include "CoreMinimal.h"
 #include "ETelekinesisStates.h"
 #include "ITelekineticProp.h"
+#include "MiniPropAttractionBuffer.h"
+#include "MiniPropOverlapCoalescer.h"
+#include "TelekineticPropNetState.h"
+#include "TelekinesisSignificance.h"
 #include "GameFramework/Actor.h"
 #include "TelekineticActor.generated.h"
 
@@ -20,9 +24,33 @@ public:
 	virtual void Pull(ATelekinesisCharacter* InPlayerCharacter) override;
 	virtual void Push(FVector Destination) override;
 	// End of ITelekineticProp interface
+
+	TObjectPtr<UStaticMeshComponent> GetMesh() const;
+	ETelekinesisStates GetTelekinesisState() const;
+	/** Which of our player's hold slots we reach for while held */
+	void SetHoldSlot(int32 InHoldSlot);
+	/** Whether a character may pull us, we can't be taken from someone else's hands */
+	bool CanBePulledBy(const ATelekinesisCharacter* InPlayerCharacter) const;
+	/** Let go of us without a Push, e.g. when the server rejects a Pull we predicted */
+	void Drop();
+	/** Our tuning, the archetype's class defaults when we don't have one */
+	const class UTelekineticPropArchetype& GetArchetype() const;
+	/** Swap our tuning, e.g. to a heavier feel. A Lift or Reach in progress keeps going with the new values */
+	UFUNCTION(BlueprintCallable, Category="Archetype")
+	void SetArchetype(class UTelekineticPropArchetype* NewArchetype);
+	/** How a Push from where we are now would start, for trajectory prediction. Scale and DampingScale are per ReachTimeStep */
+	void GetPushPrediction(FVector& OutLocation, FVector& OutVelocity, float& OutScale, float& OutDampingScale) const;
+
+	// AActor interface
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+	virtual bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
+	virtual void PostLoad() override;
+	// End of AActor interface
 	
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	UFUNCTION()
 	void OnHitCallback(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
@@ -30,12 +58,21 @@ protected:
 	void ActivateParticleSystem();
 	UFUNCTION(BlueprintImplementableEvent)
 	void DeactivateParticleSystem();
+	/** Only called when we have no ParticleSystem or ParticleLocationParameter, see FeedParticleLocation */
 	UFUNCTION(BlueprintImplementableEvent)
 	void FeedLocationToParticleSystem();
+	/** Only called when we have no SparksSystem, rate limited and budgeted like the pooled sparks */
 	UFUNCTION(BlueprintImplementableEvent)
 	void SpawnSparks(const FVector& Impulse);
+	/** Our significance changed how many particles we should spawn, NiagaraSpawnRate scaled by our bucket */
+	UFUNCTION(BlueprintImplementableEvent)
+	void SetNiagaraSpawnRate(float SpawnRate);
 
 private:
+	friend class UTelekinesisWorldSubsystem;
+	friend class UTelekineticPropEntitySubsystem;
+	friend class UTelekinesisReplaySubsystem;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Component", meta=(AllowPrivateAccess = "true"))
 	TObjectPtr<UStaticMeshComponent> TelekineticMesh;
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Component", meta = (AllowPrivateAccess = "true"))
@@ -43,91 +80,146 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Component", meta = (AllowPrivateAccess = "true"))
 	class UAudioComponent* AudioComponent;
 	
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Lift", meta=(AllowPrivateAccess = "true"))
-	float LiftDurationSeconds = 0.5f;
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Lift", meta=(AllowPrivateAccess = "true"))
-	float LiftHeight = 150.f;
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Lift", meta=(AllowPrivateAccess = "true"))
-	FVector LiftAngularImpulseDirection = FVector(1.f, 1.f, 1.f);
-	/** Minimum angular impulse applied to lifted objects so they aren't static */ 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Lift", meta=(AllowPrivateAccess = "true"))
-	float LiftAngularImpulseMinStrength = 400.f;
-	/** Maximum angular impulse applied to lifted objects so they aren't static */ 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Lift", meta=(AllowPrivateAccess = "true"))
-	float LiftAngularImpulseMaxStrength = 800.f;
-	/** The percentage of our Lift phase at which we'll start the Reach phase for a smooth transition */ 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Lift", meta=(AllowPrivateAccess = "true"))
-	float LiftReachTransitionPercent = 0.8f;
-
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Reach", meta=(AllowPrivateAccess = "true"))
-	float PullSpeedMultiplier = 1.f;
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Reach", meta=(AllowPrivateAccess = "true"))
-	float PushSpeedMultiplier = 800.f;
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Reach", meta=(AllowPrivateAccess = "true"))
-	float MassMinRange = 50.f;
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Reach", meta=(AllowPrivateAccess = "true"))
-	float MassMaxRange = 700.f;
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Reach", meta=(AllowPrivateAccess = "true"))
-	float MassMultiplierMinRange = 1.f;
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Reach", meta=(AllowPrivateAccess = "true"))
-	float MassMultiplierMaxRange = 5.f;
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Reach", meta=(AllowPrivateAccess = "true"))
-	float CollisionBounciness = 2.f;
-	
-	/** Min frame time for object to randomly Jitter */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Jitter", meta=(AllowPrivateAccess = "true"))
-	float JitterFrameTimeRangeMin = 10.f;
-	/** Max frame time for object to randomly Jitter */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Jitter", meta=(AllowPrivateAccess = "true"))
-	float JitterFrameTimeRangeMax = 30.f;
-	/** Minimum strength of a Jitter */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Jitter", meta=(AllowPrivateAccess = "true"))
-	float JitterStrengthMinMultiplier = 100.f;
-	/** Maximum strength of a Jitter */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Jitter", meta=(AllowPrivateAccess = "true"))
-	float JitterStrengthMaxMultiplier = 300.f;
-	
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="VFX", meta=(AllowPrivateAccess = "true"))
-	float NiagaraSpawnRate = 2000.f;
+	/** Our lift, reach, jitter, VFX and sound tuning, shared with every prop using the same archetype. None uses the defaults */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Archetype", meta=(AllowPrivateAccess = "true"))
+	class UTelekineticPropArchetype* Archetype = nullptr;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Sounds", meta=(AllowPrivateAccess = "true"))
-	class USoundBase* PushSound = nullptr;
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Sounds", meta=(AllowPrivateAccess = "true"))
-	class USoundBase* LiftSound = nullptr;
+	// Tuning we had before it moved into UTelekineticPropArchetype, only loaded so PostLoad can carry overrides over
+	UPROPERTY()
+	float LiftDurationSeconds_DEPRECATED = 0.5f;
+	UPROPERTY()
+	float LiftHeight_DEPRECATED = 150.f;
+	UPROPERTY()
+	FVector LiftAngularImpulseDirection_DEPRECATED = FVector(1.f, 1.f, 1.f);
+	UPROPERTY()
+	float LiftAngularImpulseMinStrength_DEPRECATED = 400.f;
+	UPROPERTY()
+	float LiftAngularImpulseMaxStrength_DEPRECATED = 800.f;
+	UPROPERTY()
+	float LiftReachTransitionPercent_DEPRECATED = 0.8f;
+	UPROPERTY()
+	float PullSpeedMultiplier_DEPRECATED = 1.f;
+	UPROPERTY()
+	float PushSpeedMultiplier_DEPRECATED = 800.f;
+	UPROPERTY()
+	float MassMinRange_DEPRECATED = 50.f;
+	UPROPERTY()
+	float MassMaxRange_DEPRECATED = 700.f;
+	UPROPERTY()
+	float MassMultiplierMinRange_DEPRECATED = 1.f;
+	UPROPERTY()
+	float MassMultiplierMaxRange_DEPRECATED = 5.f;
+	UPROPERTY()
+	float CollisionBounciness_DEPRECATED = 2.f;
+	UPROPERTY()
+	float JitterFrameTimeRangeMin_DEPRECATED = 10.f;
+	UPROPERTY()
+	float JitterFrameTimeRangeMax_DEPRECATED = 30.f;
+	UPROPERTY()
+	float JitterStrengthMinMultiplier_DEPRECATED = 100.f;
+	UPROPERTY()
+	float JitterStrengthMaxMultiplier_DEPRECATED = 300.f;
+	UPROPERTY()
+	float NiagaraSpawnRate_DEPRECATED = 2000.f;
+	UPROPERTY()
+	class USoundBase* PushSound_DEPRECATED = nullptr;
+	UPROPERTY()
+	class USoundBase* LiftSound_DEPRECATED = nullptr;
 
-	// Variables for Lift
-	FTimerHandle LiftTimerHandle;
-	float LiftStartTimeSeconds = 0.f;
-	FVector LiftStart = FVector::ZeroVector;
-	FVector LiftEnd = FVector::ZeroVector;
+	/** The held particle system we feed our location to, defaults to our first Niagara component */
+	UPROPERTY(BlueprintReadWrite, Category="VFX", meta=(AllowPrivateAccess = "true"))
+	class UNiagaraComponent* ParticleSystem = nullptr;
 
-	// Variables for Reach
-	FTimerHandle ReachTimerHandle;
-	FVector ReachTarget = FVector::ZeroVector;
+	/** Replication bandwidth a held or pushed prop may use, in bytes per second. Sets our NetUpdateFrequency */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Network", meta=(AllowPrivateAccess = "true", ClampMin=0))
+	float ActiveNetBytesPerSecond = 1024.f;
+	/** NetUpdateFrequency while we're not held or pushed */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Network", meta=(AllowPrivateAccess = "true", ClampMin=0))
+	float IdleNetUpdateFrequency = 2.f;
+	/** Props only replicate to viewers this far beyond the viewer's TelekinesisDistance */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Network", meta=(AllowPrivateAccess = "true"))
+	float NetRelevancyPadding = 1000.f;
+	/** Once we're back in Default, we go dormant after moving slower than this for SettleSeconds */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Network", meta=(AllowPrivateAccess = "true"))
+	float SettleSpeed = 5.f;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Network", meta=(AllowPrivateAccess = "true"))
+	float SettleSeconds = 0.5f;
+	/** How long clients take to blend out the error between their prediction and the server */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Network", meta=(AllowPrivateAccess = "true", ClampMin=0))
+	float ReconcileSeconds = 0.15f;
+	/** Clients further than this from the server snap instead of blending */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Network", meta=(AllowPrivateAccess = "true"))
+	float ReconcileSnapDistance = 300.f;
+	/** How much of the server's velocity clients take on each update */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Network", meta=(AllowPrivateAccess = "true", ClampMin=0, ClampMax=1))
+	float ReconcileVelocityBlend = 0.5f;
 
-	// Variables for Jitter
-	int32 JitterFrameTime = 0;
-	int32 JitterCounter = 0;
+	/** In standalone games, become a Mass entity whenever we're idle and at rest, see UTelekineticPropEntitySubsystem */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category="Mass", meta=(AllowPrivateAccess = "true"))
+	bool bIdleAsEntity = false;
+
+	// Our Lift/Reach/Jitter state lives in the UTelekinesisWorldSubsystem, these index into it
+	int32 LiftStateIndex = INDEX_NONE;
+	int32 ReachStateIndex = INDEX_NONE;
 
 	// Variables for attracting AMiniTelekineticActors
-	TArray<class AMiniTelekineticActor*> AttractedMiniProps;
+	FMiniPropAttractionBuffer AttractedMiniProps;
+	FMiniPropOverlapCoalescer MiniPropOverlaps;
+	
+	// Replication, the server sends NetState and clients blend towards it
+	UPROPERTY(ReplicatedUsing=OnRep_NetState)
+	FTelekineticPropNetState NetState;
+	FVector ReconcileOffset = FVector::ZeroVector;
+	FQuat ReconcileRotationOffset = FQuat::Identity;
+	float SettledSeconds = 0.f;
+	
+	// This frame's push contacts, handled once by FlushPushHit
+	FHitResult PendingPushHit;
+	float PendingPushHitImpulse = 0.f;
+	float PendingPushHitStrongest = 0.f;
+	bool bPushHitQueued = false;
 	
 	// Other variables
+	UPROPERTY(Replicated)
 	class ATelekinesisCharacter* PlayerCharacter = nullptr;
 	ETelekinesisStates TelekinesisState = ETelekinesisStates::Default;
+	int32 HoldSlot = INDEX_NONE;
 	FVector PushDestination = FVector::ZeroVector;
 	FVector PushDirection = FVector::ZeroVector;
+	bool bWantsWindAudio = false;
+	bool bParticleFeedQueued = false;
+	/** Lighter objects move faster, heavier objects move slower. Captured when we're pulled, see UpdateMassMultiplier */
+	float MassMultiplier = 1.f;
+	/** Every random Reach and Jitter value, seeded per prop so a session can be replayed, see UTelekinesisReplaySubsystem */
+	FRandomStream RandomStream;
+	/** Seeds the physics thread's Jitter, drawn from RandomStream at the start of each Reach */
+	int32 AsyncJitterSeed = 0;
+
+	// Significance, only tracked while we're held or pushed
+	bool bSignificanceRegistered = false;
+	/** Index into SignificanceBuckets, INDEX_NONE when culled */
+	int32 SignificanceBucket = 0;
 
 	// Lift phase
 	void StartLift();
-	void Lift();
+	/** Returns true once the Lift phase has finished */
+	bool Lift(struct FTelekinesisLiftState& State, float CurrTimeSeconds);
 
 	// Reach phase
-	void StartReach(bool bReachCharacter);
-	void ReachCharacter();
-	void ReachPoint();
-	void ReachLocation(const FVector& Target, float ReachSpeedMultiplier, bool bConstantSpeed);
-	void ClearReachTimer();
+	void StartReach(bool bReachCharacter, const FVector& Target = FVector::ZeroVector);
+	void Reach(struct FTelekinesisReachState& State);
+	void ReachCharacter(FTelekinesisReachState& State);
+	void ReachPoint(FTelekinesisReachState& State);
+	void ReachLocation(FTelekinesisReachState& State, const FVector& Location, float ReachSpeedMultiplier, bool bConstantSpeed);
+	void FixedStepReach(FTelekinesisReachState& State, float DeltaTime);
+	FVector GetReachImpulse(const FVector& From, const FVector& Location, float SpeedMultiplier, bool bConstantSpeed) const;
+	/** Capture MassMultiplier for our archetype and current mass, our mass doesn't change while we're held */
+	void UpdateMassMultiplier();
+	/** Seed RandomStream from the session's random seed and our name */
+	void SeedRandomStream();
+	/** Describe our Lift/Reach and attracted mini props for FTelekinesisSimCallback */
+	void AddAsyncPhysicsInput(const FTelekinesisLiftState* LiftState, const FTelekinesisReachState* ReachState, struct FTelekinesisAsyncInput& Input) const;
+	void ClearReach();
 
 	// Mini Prop Attraction
 	UFUNCTION()
@@ -135,12 +227,58 @@ private:
 	UFUNCTION()
 	void OnEndOverlap(class UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
 	void DetectMiniProps();
-	void AttractMiniProps();
+	/** Apply this frame's coalesced AttractionField overlaps */
+	void FlushMiniPropOverlaps();
+	void QueueMiniPropOverlap(class AMiniTelekineticActor* MiniProp, bool bOverlapping);
+	/** Release every attracted mini prop and stop capturing new ones */
+	void ReleaseMiniProps();
+	/** StrengthScale makes up for attraction steps our significance skipped */
+	void AttractMiniProps(float StrengthScale = 1.f);
 	void AddMiniProp(class AMiniTelekineticActor* MiniProp);
 	void RemoveMiniProp(class AMiniTelekineticActor* MiniProp);
 	
+	// Replication
+	UFUNCTION()
+	void OnRep_NetState(const FTelekineticPropNetState& OldNetState);
+	void StartReconcile();
+	/** Blend out some of our reconcile error, returns true once it's all gone */
+	bool Reconcile(float DeltaTime);
+	void SetTelekinesisState(ETelekinesisStates NewState);
+	void UpdateNetUpdateFrequency();
+	/** Server only, returns true once we've stopped moving and gone dormant, or we've been pulled again */
+	bool Settle(float DeltaTime);
+
+	// Push hits
+	/** Hit events only reach us while we're pushed, a resting prop costs the physics scene no contact notifies */
+	void UpdateHitNotifies();
+	/** End our push if this frame's coalesced contacts hit hard enough */
+	void FlushPushHit();
+	/** React to a push hit over MinPushHitImpulse, Impulse is the frame's summed contact impulse */
+	virtual void HandlePushImpact(const FHitResult& Hit, float Impulse);
+	
+	// Particles
+	/** Have our location fed to our particle systems at the end of this frame */
+	void FeedParticleLocation();
+	/** Write our location to ParticleSystem, returns false if we don't feed it natively */
+	bool FlushParticleFeed();
+
 	// Other functions
-	void Jitter();
-	float GetLiftEndTimeSeconds() const;
+	void OnMeshTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+	/** Returns the Jitter impulse to apply this step, zero if we shouldn't Jitter yet. Steps is how many Reach steps this counts for */
+	FVector Jitter(FTelekinesisReachState& State, int32 Steps = 1);
+	float GetLiftEndTimeSeconds(float LiftStartTimeSeconds) const;
+	class UTelekinesisWorldSubsystem* GetTelekinesisSubsystem() const;
+	/** Play one of our 2D sounds through the pooled UTelekinesisEffectsSubsystem when there is one */
+	void PlayOneShotSound(class USoundBase* Sound);
+
+	// Significance
+	void SetSignificanceRegistered(bool bRegister);
+	/** Our significance to one viewer, the number of buckets beyond ours so closer is higher, 0 when culled */
+	float CalculateSignificance(const FTransform& Viewpoint) const;
+	void SetSignificanceBucket(int32 Bucket);
+	const FTelekinesisSignificanceBucket& GetSignificance() const;
+	/** Whether work that runs every Interval Reach steps at our significance is due */
+	static bool IsSignificanceStep(const FTelekinesisReachState& State, int32 Interval);
+	void UpdateWindAudio(bool bRestart);
 	
 };
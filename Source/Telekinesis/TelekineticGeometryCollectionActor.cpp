@@ -0,0 +1,122 @@
+#include "TelekineticGeometryCollectionActor.h"
+#include "TelekinesisWorldSubsystem.h"
+#include "Field/FieldSystemObjects.h"
+#include "GeometryCollection/GeometryCollectionComponent.h"
+#include "GeometryCollection/GeometryCollectionObject.h"
+
+void ATelekineticGeometryCollectionActor::Pull(ATelekinesisCharacter* InPlayerCharacter)
+{
+	// Our fragments are on their own now
+	if (bFractured)
+	{
+		return;
+	}
+	Super::Pull(InPlayerCharacter);
+}
+
+void ATelekineticGeometryCollectionActor::HandlePushImpact(const FHitResult& Hit, float Impulse)
+{
+	Super::HandlePushImpact(Hit, Impulse);
+	if (!bFractured && RestCollection != nullptr && Impulse >= FractureImpulse)
+	{
+		FractureLocation = Hit.ImpactPoint;
+		GetTelekinesisSubsystem()->QueueFracture(this);
+	}
+}
+
+void ATelekineticGeometryCollectionActor::Fracture()
+{
+	if (bFractured || RestCollection == nullptr)
+	{
+		return;
+	}
+	bFractured = true;
+	UStaticMeshComponent* Mesh = GetMesh();
+	const FVector LinearVelocity = Mesh->GetPhysicsLinearVelocity();
+	const FVector AngularVelocity = Mesh->GetPhysicsAngularVelocityInDegrees();
+
+	// We stop being a prop, nothing can target or move us any more
+	GetTelekinesisSubsystem()->RemoveProp(this);
+	ReleaseMiniProps();
+	Mesh->SetSimulatePhysics(false);
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Mesh->SetVisibility(false);
+
+	// Our fragments only exist from here on, so intact props never pay for a geometry collection
+	Fragments = NewObject<UGeometryCollectionComponent>(this, TEXT("Fragments"));
+	Fragments->SetRestCollection(RestCollection);
+	Fragments->ObjectType = EObjectStateTypeEnum::Chaos_Object_Dynamic;
+	Fragments->InitialVelocityType = EInitialVelocityTypeEnum::Chaos_Initial_Velocity_User_Defined;
+	Fragments->InitialLinearVelocity = LinearVelocity;
+	Fragments->InitialAngularVelocity = AngularVelocity;
+	Fragments->SetupAttachment(Mesh);
+	Fragments->RegisterComponent();
+
+	// Break the clusters around the impact, and let slow fragments sleep
+	StrainField = NewObject<URadialFalloff>(this);
+	StrainField->SetRadialFalloff(FractureStrain, 0.f, 1.f, 0.f, FractureRadius, FractureLocation, EFieldFalloffType::Field_FallOff_None);
+	Fragments->ApplyPhysicsField(true, EGeometryCollectionPhysicsTypeEnum::Chaos_ExternalClusterStrain, nullptr, StrainField);
+	FragmentSleepField = NewObject<UUniformScalar>(this);
+	FragmentSleepField->SetUniformScalar(FragmentSleepSpeed);
+	Fragments->ApplyPhysicsField(true, EGeometryCollectionPhysicsTypeEnum::Chaos_SleepingThreshold, nullptr, FragmentSleepField);
+
+	FragmentStateField = NewObject<UUniformInteger>(this);
+	FragmentAttractionMask = NewObject<URadialFalloff>(this);
+	FragmentAttractionVelocity = NewObject<URadialVector>(this);
+	FragmentAttractionField = NewObject<UCullingField>(this);
+	FragmentAttractionField->SetCullingField(FragmentAttractionMask, FragmentAttractionVelocity, EFieldCullingOperationType::Field_Culling_Outside);
+
+	if (FragmentLifeSeconds > 0.f)
+	{
+		SetLifeSpan(FragmentLifeSeconds);
+	}
+}
+
+void ATelekineticGeometryCollectionActor::UpdateFragments(float DeltaTime, const TArray<FSphere>& Attractors)
+{
+	if (Fragments == nullptr)
+	{
+		return;
+	}
+	// Like mini props, fragments go to the closest held prop whose attraction radius reaches them
+	const FBoxSphereBounds& Bounds = Fragments->Bounds;
+	const FSphere* ClosestAttractor = nullptr;
+	float ClosestDistanceSquared = TNumericLimits<float>::Max();
+	for (const FSphere& Attractor : Attractors)
+	{
+		const float DistanceSquared = FVector::DistSquared(Attractor.Center, Bounds.Origin);
+		if (DistanceSquared < FMath::Square(Attractor.W + Bounds.SphereRadius) && DistanceSquared < ClosestDistanceSquared)
+		{
+			ClosestDistanceSquared = DistanceSquared;
+			ClosestAttractor = &Attractor;
+		}
+	}
+
+	if (ClosestAttractor == nullptr)
+	{
+		// Put every fragment to sleep at once, rather than waiting for the slowest one
+		FragmentIdleSeconds += DeltaTime;
+		if (!bFragmentsAsleep && FragmentIdleSeconds >= FragmentSleepSeconds)
+		{
+			SetFragmentState(static_cast<int32>(EObjectStateTypeEnum::Chaos_Object_Sleeping));
+			bFragmentsAsleep = true;
+		}
+		return;
+	}
+	FragmentIdleSeconds = 0.f;
+	if (bFragmentsAsleep)
+	{
+		SetFragmentState(static_cast<int32>(EObjectStateTypeEnum::Chaos_Object_Dynamic));
+		bFragmentsAsleep = false;
+	}
+	// Fragments inside the attraction radius move towards the prop's center
+	FragmentAttractionMask->SetRadialFalloff(1.f, 0.f, 1.f, 0.f, ClosestAttractor->W, ClosestAttractor->Center, EFieldFalloffType::Field_FallOff_None);
+	FragmentAttractionVelocity->SetRadialVector(-FragmentAttractionSpeed, ClosestAttractor->Center);
+	Fragments->ApplyPhysicsField(true, EGeometryCollectionPhysicsTypeEnum::Chaos_LinearVelocity, nullptr, FragmentAttractionField);
+}
+
+void ATelekineticGeometryCollectionActor::SetFragmentState(int32 ObjectState)
+{
+	FragmentStateField->SetUniformInteger(ObjectState);
+	Fragments->ApplyPhysicsField(true, EGeometryCollectionPhysicsTypeEnum::Chaos_DynamicState, nullptr, FragmentStateField);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TelekineticActor.h"
+#include "TelekineticGeometryCollectionActor.generated.h"
+
+/**
+ * A telekinetic prop that shatters when it's pushed into something hard enough.
+ * Until then it's an ordinary ATelekineticActor with a static mesh, so intact props cost no more than any other prop.
+ * On a big enough push impact it asks the UTelekinesisWorldSubsystem to fracture it, which swaps the mesh for a Chaos
+ * geometry collection broken by a strain field at the impact, at most MaxFracturesPerFrame a frame so chain reactions
+ * spread over a few frames instead of spiking one. Fragments are pulled towards held props like mini props, sleep as a whole
+ * after FragmentSleepSeconds and are removed with the actor after FragmentLifeSeconds.
+ */
+UCLASS()
+class TELEKINESIS_API ATelekineticGeometryCollectionActor : public ATelekineticActor
+{
+	GENERATED_BODY()
+
+public:
+	// ITelekineticProp interface
+	virtual void Pull(ATelekinesisCharacter* InPlayerCharacter) override;
+	// End of ITelekineticProp interface
+
+	bool IsFractured() const { return bFractured; }
+
+protected:
+	virtual void HandlePushImpact(const FHitResult& Hit, float Impulse) override;
+
+private:
+	friend class UTelekinesisWorldSubsystem;
+
+	/** The fractured version of our mesh, swapped in when we break */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Fracture", meta=(AllowPrivateAccess = "true"))
+	class UGeometryCollection* RestCollection = nullptr;
+	/** Push impacts at least this strong break us, weaker ones just bounce */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Fracture", meta=(AllowPrivateAccess = "true"))
+	float FractureImpulse = 2000.f;
+	/** Strain applied around the impact, compare with the damage thresholds of the geometry collection */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Fracture", meta=(AllowPrivateAccess = "true"))
+	float FractureStrain = 500000.f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Fracture", meta=(AllowPrivateAccess = "true"))
+	float FractureRadius = 100.f;
+	/** Fragments slower than this may sleep */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Fracture|Fragments", meta=(AllowPrivateAccess = "true"))
+	float FragmentSleepSpeed = 10.f;
+	/** Seconds away from any held prop before every fragment is put to sleep at once */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Fracture|Fragments", meta=(AllowPrivateAccess = "true"))
+	float FragmentSleepSeconds = 3.f;
+	/** Seconds after we break before we and our fragments are removed, 0 keeps them */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Fracture|Fragments", meta=(AllowPrivateAccess = "true"))
+	float FragmentLifeSeconds = 15.f;
+	/** Speed fragments are pulled towards a held prop at, while inside its attraction radius */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Fracture|Fragments", meta=(AllowPrivateAccess = "true"))
+	float FragmentAttractionSpeed = 600.f;
+
+	UPROPERTY()
+	class UGeometryCollectionComponent* Fragments = nullptr;
+	// Fields we apply to our fragments, created once when we break and reused
+	UPROPERTY()
+	class URadialFalloff* StrainField = nullptr;
+	UPROPERTY()
+	class UUniformInteger* FragmentStateField = nullptr;
+	UPROPERTY()
+	class UUniformScalar* FragmentSleepField = nullptr;
+	UPROPERTY()
+	class URadialFalloff* FragmentAttractionMask = nullptr;
+	UPROPERTY()
+	class URadialVector* FragmentAttractionVelocity = nullptr;
+	UPROPERTY()
+	class UCullingField* FragmentAttractionField = nullptr;
+
+	bool bFractured = false;
+	FVector FractureLocation = FVector::ZeroVector;
+	float FragmentIdleSeconds = 0.f;
+	bool bFragmentsAsleep = false;
+
+	/** Swap our mesh for our fragments and break them, called by the subsystem within its fracture budget */
+	void Fracture();
+	/** Attract our fragments to any held prop in reach, or put them to sleep once none has been for FragmentSleepSeconds */
+	void UpdateFragments(float DeltaTime, const TArray<FSphere>& Attractors);
+	void SetFragmentState(int32 ObjectState);
+
+};
@@ -0,0 +1,101 @@
+#include "TelekineticPropArchetype.h"
+
+UTelekineticPropArchetype::UTelekineticPropArchetype()
+{
+	// Full fidelity up close, then fewer particle feeds, Jitters and attraction updates, and no wind sound far away
+	const auto MakeSignificanceBucket = [](float MaxDistance, int32 ParticleFeedInterval, int32 PhysicsInterval, bool bAudio, float NiagaraSpawnRateScale)
+	{
+		FTelekinesisSignificanceBucket Bucket;
+		Bucket.MaxDistance = MaxDistance;
+		Bucket.ParticleFeedInterval = ParticleFeedInterval;
+		Bucket.PhysicsInterval = PhysicsInterval;
+		Bucket.bAudio = bAudio;
+		Bucket.NiagaraSpawnRateScale = NiagaraSpawnRateScale;
+		return Bucket;
+	};
+	SignificanceBuckets.Add(MakeSignificanceBucket(1500.f, 1, 1, true, 1.f));
+	SignificanceBuckets.Add(MakeSignificanceBucket(4000.f, 2, 2, true, 0.5f));
+	SignificanceBuckets.Add(MakeSignificanceBucket(8000.f, 4, 4, false, 0.25f));
+	CulledSignificance = MakeSignificanceBucket(0.f, 0, 8, false, 0.f);
+}
+
+void UTelekineticPropArchetype::PostInitProperties()
+{
+	Super::PostInitProperties();
+	BuildMassMultiplierTable();
+}
+
+void UTelekineticPropArchetype::PostLoad()
+{
+	Super::PostLoad();
+	BuildMassMultiplierTable();
+}
+
+#if WITH_EDITOR
+void UTelekineticPropArchetype::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	BuildMassMultiplierTable();
+}
+#endif
+
+void UTelekineticPropArchetype::BuildMassMultiplierTable()
+{
+	const FRichCurve* Curve = MassMultiplierCurve.GetRichCurveConst();
+	const bool bCurve = Curve != nullptr && Curve->GetNumKeys() > 0;
+	MassMultiplierTable.SetNumUninitialized(MassMultiplierTableSize);
+	for (int32 Index = 0; Index < MassMultiplierTableSize; ++Index)
+	{
+		const float Alpha = static_cast<float>(Index) / (MassMultiplierTableSize - 1);
+		MassMultiplierTable[Index] = bCurve
+			? Curve->Eval(FMath::Lerp(MassMinRange, MassMaxRange, Alpha))
+			: FMath::Lerp(MassMultiplierMaxRange, MassMultiplierMinRange, Alpha);
+	}
+}
+
+UTelekineticPropArchetype* UTelekineticPropArchetype::CreateFromDeprecatedProperties(UObject* Owner)
+{
+	// Pair each of our properties with the owner's deprecated copy of it, if it still has one
+	const UTelekineticPropArchetype* Defaults = GetDefault<UTelekineticPropArchetype>();
+	TArray<TPair<const FProperty*, const FProperty*>, TInlineAllocator<32>> Migrations;
+	bool bOverridden = false;
+	for (TFieldIterator<FProperty> It(StaticClass()); It; ++It)
+	{
+		const FProperty* DeprecatedProperty = FindFProperty<FProperty>(Owner->GetClass(), *(It->GetName() + TEXT("_DEPRECATED")));
+		if (DeprecatedProperty == nullptr || !DeprecatedProperty->SameType(*It))
+		{
+			continue;
+		}
+		Migrations.Emplace(*It, DeprecatedProperty);
+		bOverridden |= !It->Identical(It->ContainerPtrToValuePtr<void>(Defaults), DeprecatedProperty->ContainerPtrToValuePtr<void>(Owner));
+	}
+	if (!bOverridden)
+	{
+		return nullptr;
+	}
+
+	UTelekineticPropArchetype* Archetype = NewObject<UTelekineticPropArchetype>(Owner, NAME_None, Owner->GetMaskedFlags(RF_Transactional));
+	for (const TPair<const FProperty*, const FProperty*>& Migration : Migrations)
+	{
+		Migration.Key->CopyCompleteValue(Migration.Key->ContainerPtrToValuePtr<void>(Archetype), Migration.Value->ContainerPtrToValuePtr<void>(Owner));
+	}
+	Archetype->BuildMassMultiplierTable();
+	return Archetype;
+}
+
+float UTelekineticPropArchetype::GetMassMultiplier(float Mass) const
+{
+	if (MassMultiplierTable.Num() == 0)
+	{
+		return MassMultiplierMaxRange;
+	}
+	const float Range = MassMaxRange - MassMinRange;
+	const float Alpha = Range > 0.f ? FMath::Clamp((Mass - MassMinRange) / Range, 0.f, 1.f) : 0.f;
+	const float Position = Alpha * (MassMultiplierTable.Num() - 1);
+	const int32 Index = FMath::Min(FMath::FloorToInt(Position), MassMultiplierTable.Num() - 2);
+	if (Index < 0)
+	{
+		return MassMultiplierTable[0];
+	}
+	return FMath::Lerp(MassMultiplierTable[Index], MassMultiplierTable[Index + 1], Position - Index);
+}
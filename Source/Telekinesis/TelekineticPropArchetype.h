@@ -0,0 +1,142 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Curves/CurveFloat.h"
+#include "Engine/DataAsset.h"
+#include "TelekinesisSignificance.h"
+#include "TelekineticPropArchetype.generated.h"
+
+/**
+ * Tuning for a kind of ATelekineticActor, shared by every prop that points at it instead of copied into each one.
+ * Swap a prop's archetype at runtime with ATelekineticActor::SetArchetype, props without one use this class's defaults.
+ */
+UCLASS(BlueprintType)
+class TELEKINESIS_API UTelekineticPropArchetype : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UTelekineticPropArchetype();
+
+	// UObject interface
+	virtual void PostInitProperties() override;
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+	// End of UObject interface
+
+	/** How much faster a prop of this mass reaches, from the table built out of MassMultiplierCurve */
+	float GetMassMultiplier(float Mass) const;
+	/**
+	 * Builds an archetype inside Owner from the tuning it saved before it moved here, read from its <Name>_DEPRECATED
+	 * properties. Null when none of them differ from our defaults, so untouched props keep sharing the class defaults.
+	 */
+	static UTelekineticPropArchetype* CreateFromDeprecatedProperties(UObject* Owner);
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Lift")
+	float LiftDurationSeconds = 0.5f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Lift")
+	float LiftHeight = 150.f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Lift")
+	FVector LiftAngularImpulseDirection = FVector(1.f, 1.f, 1.f);
+	/** Minimum angular impulse applied to lifted objects so they aren't static */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Lift")
+	float LiftAngularImpulseMinStrength = 400.f;
+	/** Maximum angular impulse applied to lifted objects so they aren't static */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Lift")
+	float LiftAngularImpulseMaxStrength = 800.f;
+	/** The percentage of our Lift phase at which we'll start the Reach phase for a smooth transition */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Lift")
+	float LiftReachTransitionPercent = 0.8f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Reach")
+	float PullSpeedMultiplier = 1.f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Reach")
+	float PushSpeedMultiplier = 800.f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Reach")
+	float MassMinRange = 50.f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Reach")
+	float MassMaxRange = 700.f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Reach")
+	float MassMultiplierMinRange = 1.f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Reach")
+	float MassMultiplierMaxRange = 5.f;
+	/** Mass multiplier by mass between MassMinRange and MassMaxRange. Without keys it falls linearly from MassMultiplierMaxRange to MassMultiplierMinRange */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Reach")
+	FRuntimeFloatCurve MassMultiplierCurve;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Reach")
+	float CollisionBounciness = 2.f;
+	/** A push only ends on hits whose contacts in one frame add up to at least this much impulse, so grazing contacts don't stop it */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Reach", meta=(ClampMin=0))
+	float MinPushHitImpulse = 500.f;
+	/** Linear damping applied while we Reach, stops us overshooting the target */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Reach")
+	float ReachLinearDamping = 20.f;
+	/** Integrate Reach ourselves at a fixed step before each physics step, so trajectories don't depend on frame rate */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Reach")
+	bool bFixedStepReach = false;
+	/** Run Lift, Reach, Jitter and mini prop attraction on the physics thread inside the Chaos solver step, instead of game thread impulses. Takes precedence over bFixedStepReach */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Reach")
+	bool bAsyncPhysicsForces = false;
+	/** Max fixed Reach steps in one frame, any time beyond that is dropped so a hitch can't spiral */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Reach", meta=(EditCondition="bFixedStepReach", ClampMin=1))
+	int32 MaxReachSubsteps = 8;
+
+	/** Min frame time for object to randomly Jitter */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Jitter")
+	float JitterFrameTimeRangeMin = 10.f;
+	/** Max frame time for object to randomly Jitter */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Jitter")
+	float JitterFrameTimeRangeMax = 30.f;
+	/** Minimum strength of a Jitter */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Jitter")
+	float JitterStrengthMinMultiplier = 100.f;
+	/** Maximum strength of a Jitter */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Jitter")
+	float JitterStrengthMaxMultiplier = 300.f;
+
+	/** Most mini props a prop can attract at once, their storage is allocated up front */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Attraction", meta=(ClampMin=0))
+	int32 MaxAttractedMiniProps = 256;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="VFX")
+	float NiagaraSpawnRate = 2000.f;
+	/** User parameter of the prop's ParticleSystem we write its location to, once per frame. None falls back to FeedLocationToParticleSystem */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="VFX")
+	FName ParticleLocationParameter = TEXT("PropLocation");
+	/** Optional system drawing every prop of this archetype at once, fed all their locations through one array user parameter */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="VFX")
+	class UNiagaraSystem* SharedParticleSystem = nullptr;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="VFX", meta=(EditCondition="SharedParticleSystem != nullptr"))
+	FName SharedParticleLocationsParameter = TEXT("PropLocations");
+	/** Sparks spawned where a push hits something, from the UTelekinesisEffectsSubsystem pool. None falls back to SpawnSparks */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="VFX")
+	class UNiagaraSystem* SparksSystem = nullptr;
+	/** User parameter of SparksSystem we write the hit impulse direction to, None writes nothing */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="VFX", meta=(EditCondition="SparksSystem != nullptr"))
+	FName SparksImpulseParameter = TEXT("Impulse");
+
+	/** While held or pushed a prop uses the first bucket whose MaxDistance reaches the nearest viewer, closest first */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Significance")
+	TArray<FTelekinesisSignificanceBucket> SignificanceBuckets;
+	/** Used beyond the last bucket, and beyond the first one when no viewer is looking our way */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Significance")
+	FTelekinesisSignificanceBucket CulledSignificance;
+	/** Half angle of a viewer's view cone, in degrees, props outside it are offscreen */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Significance", meta=(ClampMin=0, ClampMax=180))
+	float SignificanceViewAngle = 70.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Sounds")
+	class USoundBase* PushSound = nullptr;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Sounds")
+	class USoundBase* LiftSound = nullptr;
+
+private:
+	/** Samples of the mass multiplier spread evenly from MassMinRange to MassMaxRange */
+	static constexpr int32 MassMultiplierTableSize = 64;
+	TArray<float> MassMultiplierTable;
+
+	void BuildMassMultiplierTable();
+
+};
@@ -0,0 +1,294 @@
+#include "TelekineticPropEntitySubsystem.h"
+#include "Telekinesis.h"
+#include "TelekineticActor.h"
+#include "TelekineticPropFragments.h"
+#include "MassCommonFragments.h"
+#include "MassEntitySubsystem.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+
+void UTelekineticPropEntitySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	EntitySubsystem = Cast<UMassEntitySubsystem>(Collection.InitializeDependency(UMassEntitySubsystem::StaticClass()));
+}
+
+void UTelekineticPropEntitySubsystem::Deinitialize()
+{
+	Queries.Empty();
+	Results.Empty();
+	PromotionRequests.Empty();
+	HighlightedEntities.Empty();
+	PromotedProps.Empty();
+	PromotedTimeSeconds.Empty();
+	Super::Deinitialize();
+}
+
+void UTelekineticPropEntitySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// This frame's sweeps have been answered, hand them out next frame
+	Results = MoveTemp(Queries);
+	Queries.Reset();
+
+	const int32 NumPromotions = FMath::Min(PromotionRequests.Num(), MaxPromotionsPerFrame);
+	for (int32 Index = 0; Index < NumPromotions; ++Index)
+	{
+		Promote(PromotionRequests[Index]);
+	}
+	PromotionRequests.RemoveAt(0, NumPromotions, false);
+
+	// Anything still over the budget shows it's been targeted until its turn
+	for (const FMassEntityHandle Entity : HighlightedEntities)
+	{
+		if (!PromotionRequests.Contains(Entity))
+		{
+			SetHighlighted(Entity, false);
+		}
+	}
+	for (const FMassEntityHandle Entity : PromotionRequests)
+	{
+		SetHighlighted(Entity, true);
+	}
+	HighlightedEntities = PromotionRequests;
+
+	UpdateDemotions();
+}
+
+TStatId UTelekineticPropEntitySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTelekineticPropEntitySubsystem, STATGROUP_Tickables);
+}
+
+bool UTelekineticPropEntitySubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UTelekineticPropEntitySubsystem::IsSupported() const
+{
+	return EntitySubsystem != nullptr && GetWorld()->GetNetMode() == NM_Standalone;
+}
+
+FMassEntityHandle UTelekineticPropEntitySubsystem::AddProp(TSubclassOf<ATelekineticActor> PropClass, const FTransform& Transform, float Mass)
+{
+	check(PropClass);
+	if (!IsSupported())
+	{
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+		GetWorld()->SpawnActor<ATelekineticActor>(PropClass, Transform, SpawnParameters);
+		return FMassEntityHandle();
+	}
+	return CreateEntity(GetClassIndex(PropClass), Transform, Mass);
+}
+
+void UTelekineticPropEntitySubsystem::TrackProp(ATelekineticActor* Prop)
+{
+	check(Prop);
+	if (IsSupported() && !PromotedProps.Contains(Prop))
+	{
+		PromotedProps.Add(Prop);
+		PromotedTimeSeconds.Add(GetWorld()->GetTimeSeconds());
+	}
+}
+
+void UTelekineticPropEntitySubsystem::QueryTarget(const AActor* Querier, const FVector& Start, const FVector& End, float Radius)
+{
+	if (NumEntities == 0)
+	{
+		return;
+	}
+	FTelekineticPropEntityQuery& Query = Queries.AddDefaulted_GetRef();
+	Query.Querier = Querier;
+	Query.Start = Start;
+	(End - Start).ToDirectionAndLength(Query.Direction, Query.Length);
+	Query.Radius = Radius;
+}
+
+FMassEntityHandle UTelekineticPropEntitySubsystem::GetTargetResult(const AActor* Querier, float& OutDistance) const
+{
+	for (const FTelekineticPropEntityQuery& Result : Results)
+	{
+		if (Result.Querier == Querier && Result.Entity.IsSet())
+		{
+			OutDistance = Result.Distance;
+			return Result.Entity;
+		}
+	}
+	return FMassEntityHandle();
+}
+
+void UTelekineticPropEntitySubsystem::RequestPromotion(FMassEntityHandle Entity)
+{
+	PromotionRequests.AddUnique(Entity);
+}
+
+int32 UTelekineticPropEntitySubsystem::GetClassIndex(TSubclassOf<ATelekineticActor> PropClass)
+{
+	const int32 ExistingIndex = PropClasses.IndexOfByKey(PropClass);
+	if (ExistingIndex != INDEX_NONE)
+	{
+		return ExistingIndex;
+	}
+
+	if (InstanceOwner == nullptr)
+	{
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.ObjectFlags |= RF_Transient;
+		InstanceOwner = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParameters);
+	}
+
+	// Draw the class's mesh the way its actor would, blocking but never simulating
+	const UStaticMeshComponent* DefaultMesh = PropClass->GetDefaultObject<ATelekineticActor>()->GetMesh();
+	UHierarchicalInstancedStaticMeshComponent* Instances = NewObject<UHierarchicalInstancedStaticMeshComponent>(InstanceOwner);
+	Instances->SetStaticMesh(DefaultMesh->GetStaticMesh());
+	for (int32 MaterialIndex = 0; MaterialIndex < DefaultMesh->GetNumMaterials(); ++MaterialIndex)
+	{
+		Instances->SetMaterial(MaterialIndex, DefaultMesh->GetMaterial(MaterialIndex));
+	}
+	Instances->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	Instances->NumCustomDataFloats = 1;
+	Instances->RegisterComponent();
+	InstanceOwner->AddInstanceComponent(Instances);
+
+	PropClasses.Add(PropClass);
+	ClassInstances.Add(Instances);
+	ClassBoundsRadius.Add(DefaultMesh->GetStaticMesh() != nullptr ? DefaultMesh->GetStaticMesh()->GetBounds().SphereRadius : 0.f);
+	FreeInstances.AddDefaulted();
+	return PropClasses.Num() - 1;
+}
+
+FMassEntityHandle UTelekineticPropEntitySubsystem::CreateEntity(int32 ClassIndex, const FTransform& Transform, float Mass)
+{
+	if (!PropArchetype.IsValid())
+	{
+		PropArchetype = EntitySubsystem->CreateArchetype({
+			FDataFragment_Transform::StaticStruct(),
+			FTelekineticPropMassFragment::StaticStruct(),
+			FTelekineticPropStateFragment::StaticStruct(),
+			FTelekineticPropHighlightFragment::StaticStruct() });
+	}
+
+	UHierarchicalInstancedStaticMeshComponent* Instances = ClassInstances[ClassIndex];
+	int32 InstanceIndex = INDEX_NONE;
+	if (FreeInstances[ClassIndex].Num() > 0)
+	{
+		InstanceIndex = FreeInstances[ClassIndex].Pop(false);
+		Instances->UpdateInstanceTransform(InstanceIndex, Transform, true, true, true);
+	}
+	else
+	{
+		InstanceIndex = Instances->AddInstance(Transform, true);
+	}
+
+	const FMassEntityHandle Entity = EntitySubsystem->CreateEntity(PropArchetype);
+	EntitySubsystem->GetFragmentDataChecked<FDataFragment_Transform>(Entity).SetTransform(Transform);
+	FTelekineticPropMassFragment& MassFragment = EntitySubsystem->GetFragmentDataChecked<FTelekineticPropMassFragment>(Entity);
+	MassFragment.Mass = Mass;
+	MassFragment.BoundsRadius = ClassBoundsRadius[ClassIndex] * Transform.GetMaximumAxisScale();
+	FTelekineticPropStateFragment& StateFragment = EntitySubsystem->GetFragmentDataChecked<FTelekineticPropStateFragment>(Entity);
+	StateFragment.ClassIndex = ClassIndex;
+	StateFragment.InstanceIndex = InstanceIndex;
+	++NumEntities;
+	return Entity;
+}
+
+ATelekineticActor* UTelekineticPropEntitySubsystem::Promote(FMassEntityHandle Entity)
+{
+	if (!EntitySubsystem->IsEntityValid(Entity))
+	{
+		return nullptr;
+	}
+	const FTransform Transform = EntitySubsystem->GetFragmentDataChecked<FDataFragment_Transform>(Entity).GetTransform();
+	const float Mass = EntitySubsystem->GetFragmentDataChecked<FTelekineticPropMassFragment>(Entity).Mass;
+	const FTelekineticPropStateFragment StateFragment = EntitySubsystem->GetFragmentDataChecked<FTelekineticPropStateFragment>(Entity);
+	EntitySubsystem->DestroyEntity(Entity);
+	--NumEntities;
+
+	// Hide the instance rather than remove it, a zero scale instance has no body either
+	FTransform HiddenTransform = Transform;
+	HiddenTransform.SetScale3D(FVector::ZeroVector);
+	UHierarchicalInstancedStaticMeshComponent* Instances = ClassInstances[StateFragment.ClassIndex];
+	Instances->UpdateInstanceTransform(StateFragment.InstanceIndex, HiddenTransform, true, true, true);
+	Instances->SetCustomDataValue(StateFragment.InstanceIndex, 0, 0.f, true);
+	FreeInstances[StateFragment.ClassIndex].Add(StateFragment.InstanceIndex);
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	ATelekineticActor* Prop = GetWorld()->SpawnActor<ATelekineticActor>(PropClasses[StateFragment.ClassIndex], Transform, SpawnParameters);
+	if (Prop == nullptr)
+	{
+		UE_LOG(LogTelekinesis, Warning, TEXT("Couldn't promote a %s entity to its actor"), *GetNameSafe(PropClasses[StateFragment.ClassIndex]));
+		return nullptr;
+	}
+	if (Mass > 0.f)
+	{
+		Prop->GetMesh()->SetMassOverrideInKg(NAME_None, Mass, true);
+	}
+	TrackProp(Prop);
+	return Prop;
+}
+
+void UTelekineticPropEntitySubsystem::UpdateDemotions()
+{
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+	const int32 NumChecks = FMath::Min(MaxDemotionChecksPerFrame, PromotedProps.Num());
+	for (int32 Check = 0; Check < NumChecks && PromotedProps.Num() > 0; ++Check)
+	{
+		const int32 PromotedIndex = NextDemotionCheck % PromotedProps.Num();
+		ATelekineticActor* Prop = PromotedProps[PromotedIndex];
+		const bool bValid = IsValid(Prop);
+		if (bValid && !CanDemote(Prop, TimeSeconds - PromotedTimeSeconds[PromotedIndex]))
+		{
+			++NextDemotionCheck;
+			continue;
+		}
+		PromotedProps.RemoveAtSwap(PromotedIndex, 1, false);
+		PromotedTimeSeconds.RemoveAtSwap(PromotedIndex, 1, false);
+		if (bValid)
+		{
+			Demote(Prop);
+		}
+	}
+}
+
+bool UTelekineticPropEntitySubsystem::CanDemote(const ATelekineticActor* Prop, float TrackedSeconds) const
+{
+	// Idle, at rest and not highlighted as anyone's target
+	return TrackedSeconds >= DemoteDelaySeconds
+		&& Prop->TelekinesisState == ETelekinesisStates::Default
+		&& Prop->LiftStateIndex == INDEX_NONE
+		&& Prop->ReachStateIndex == INDEX_NONE
+		&& !Prop->GetMesh()->IsAnyRigidBodyAwake()
+		&& !Prop->GetMesh()->bRenderCustomDepth;
+}
+
+void UTelekineticPropEntitySubsystem::Demote(ATelekineticActor* Prop)
+{
+	const int32 ClassIndex = GetClassIndex(Prop->GetClass());
+	const FTransform Transform = Prop->GetActorTransform();
+	const float Mass = Prop->GetMesh()->GetMass();
+	Prop->Destroy();
+	CreateEntity(ClassIndex, Transform, Mass);
+}
+
+void UTelekineticPropEntitySubsystem::SetHighlighted(FMassEntityHandle Entity, bool bHighlighted)
+{
+	if (!EntitySubsystem->IsEntityValid(Entity))
+	{
+		return;
+	}
+	FTelekineticPropHighlightFragment& HighlightFragment = EntitySubsystem->GetFragmentDataChecked<FTelekineticPropHighlightFragment>(Entity);
+	if (HighlightFragment.bHighlighted == bHighlighted)
+	{
+		return;
+	}
+	HighlightFragment.bHighlighted = bHighlighted;
+	// Custom depth is per component, so instances show it through their custom data instead
+	const FTelekineticPropStateFragment& StateFragment = EntitySubsystem->GetFragmentDataChecked<FTelekineticPropStateFragment>(Entity);
+	ClassInstances[StateFragment.ClassIndex]->SetCustomDataValue(StateFragment.InstanceIndex, 0, bHighlighted ? 1.f : 0.f, true);
+}
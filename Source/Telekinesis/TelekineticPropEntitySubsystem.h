@@ -0,0 +1,114 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TelekineticPropEntitySubsystem.generated.h"
+
+/** An aim sweep posted by a character, and the closest prop entity UTelekineticPropTargetProcessor found in it */
+struct FTelekineticPropEntityQuery
+{
+	TWeakObjectPtr<const AActor> Querier;
+	FVector Start = FVector::ZeroVector;
+	FVector Direction = FVector::ForwardVector;
+	float Length = 0.f;
+	float Radius = 0.f;
+
+	FMassEntityHandle Entity;
+	/** Distance along the sweep where the entity's bounds start */
+	float Distance = 0.f;
+};
+
+/**
+ * Keeps idle ATelekineticActors as Mass entities drawn by one instanced mesh per prop class, so open areas can have
+ * far more props than we could afford actors for. Entities are promoted back to their actor when a character targets
+ * them, and go through the usual ITelekineticProp Pull/Push from there. Promoted props become entities again once
+ * they've come to rest and nobody is aiming at them.
+ * Entities only exist on this machine, so this is a standalone game feature, networked games keep every prop an actor.
+ * Entities are only added, promoted and removed in our Tick, after the Mass processing phases are done for the frame.
+ */
+UCLASS()
+class TELEKINESIS_API UTelekineticPropEntitySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End of USubsystem interface
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+	/** Whether props in this world can be entities */
+	bool IsSupported() const;
+
+	/** Add an idle prop as an entity. Spawns its actor instead if entities aren't supported, returning an unset handle */
+	FMassEntityHandle AddProp(TSubclassOf<class ATelekineticActor> PropClass, const FTransform& Transform, float Mass = 0.f);
+	/** Turn a prop into an entity once it's idle, at rest and nobody is aiming at it */
+	void TrackProp(ATelekineticActor* Prop);
+
+	/** Post an aim sweep, its closest entity can be read with GetTargetResult from the next frame. Only call during TG_PrePhysics */
+	void QueryTarget(const AActor* Querier, const FVector& Start, const FVector& End, float Radius);
+	/** The closest entity in Querier's last answered sweep, unset if there was none */
+	FMassEntityHandle GetTargetResult(const AActor* Querier, float& OutDistance) const;
+	/** Have an entity promoted to its actor at the end of this frame, it's highlighted until then */
+	void RequestPromotion(FMassEntityHandle Entity);
+
+	int32 GetNumEntities() const { return NumEntities; }
+	int32 GetNumPromoted() const { return PromotedProps.Num(); }
+
+	/** Spawning actors is expensive, anything over this waits for the next frame */
+	int32 MaxPromotionsPerFrame = 4;
+	/** How many tracked props we check for demotion each frame */
+	int32 MaxDemotionChecksPerFrame = 16;
+	/** Tracked props stay actors at least this long, so a prop we've just promoted is still there to be targeted */
+	float DemoteDelaySeconds = 2.f;
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	friend class UTelekineticPropTargetProcessor;
+
+	UPROPERTY()
+	class UMassEntitySubsystem* EntitySubsystem = nullptr;
+	FMassArchetypeHandle PropArchetype;
+	int32 NumEntities = 0;
+
+	// Prop classes we have entities of, and the instances drawing them
+	UPROPERTY()
+	TArray<TSubclassOf<ATelekineticActor>> PropClasses;
+	UPROPERTY()
+	TArray<class UHierarchicalInstancedStaticMeshComponent*> ClassInstances;
+	TArray<float> ClassBoundsRadius;
+	/** Hidden instances of each class, reused before we add new ones so instance indices stay stable */
+	TArray<TArray<int32>> FreeInstances;
+	UPROPERTY()
+	AActor* InstanceOwner = nullptr;
+
+	// Aim sweeps, answered by UTelekineticPropTargetProcessor during PostPhysics and handed out the next frame
+	TArray<FTelekineticPropEntityQuery> Queries;
+	TArray<FTelekineticPropEntityQuery> Results;
+
+	TArray<FMassEntityHandle> PromotionRequests;
+	TArray<FMassEntityHandle> HighlightedEntities;
+
+	// Actors that go back to being entities once idle
+	UPROPERTY()
+	TArray<ATelekineticActor*> PromotedProps;
+	TArray<float> PromotedTimeSeconds;
+	int32 NextDemotionCheck = 0;
+
+	int32 GetClassIndex(TSubclassOf<ATelekineticActor> PropClass);
+	FMassEntityHandle CreateEntity(int32 ClassIndex, const FTransform& Transform, float Mass);
+	ATelekineticActor* Promote(FMassEntityHandle Entity);
+	void UpdateDemotions();
+	bool CanDemote(const ATelekineticActor* Prop, float TrackedSeconds) const;
+	void Demote(ATelekineticActor* Prop);
+	void SetHighlighted(FMassEntityHandle Entity, bool bHighlighted);
+
+};
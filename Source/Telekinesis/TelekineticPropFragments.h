@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ETelekinesisStates.h"
+#include "MassEntityTypes.h"
+#include "TelekineticPropFragments.generated.h"
+
+// Fragments of an idle telekinetic prop living as a Mass entity, see UTelekineticPropEntitySubsystem.
+// Its transform is the usual FDataFragment_Transform.
+
+/** What the prop's physics body needs back when it's promoted to an actor */
+USTRUCT()
+struct TELEKINESIS_API FTelekineticPropMassFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	/** Mass of the body in kg, 0 to keep the class default */
+	float Mass = 0.f;
+	/** Radius of the prop's bounds, for aim tests */
+	float BoundsRadius = 0.f;
+};
+
+USTRUCT()
+struct TELEKINESIS_API FTelekineticPropStateFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	/** Entities are always idle, this is what the prop's actor starts in */
+	ETelekinesisStates State = ETelekinesisStates::Default;
+	/** Which prop class we are, and our instance of that class's mesh */
+	int32 ClassIndex = INDEX_NONE;
+	int32 InstanceIndex = INDEX_NONE;
+};
+
+USTRUCT()
+struct TELEKINESIS_API FTelekineticPropHighlightFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	/** Aimed at while waiting to be promoted, drawn through the instance's custom data */
+	bool bHighlighted = false;
+};
@@ -0,0 +1,190 @@
+#include "TelekineticPropGrid.h"
+#include "TelekineticActor.h"
+
+FTelekineticPropGrid::FTelekineticPropGrid(float InCellSize)
+	: CellSize(InCellSize)
+{
+	check(CellSize > 0.f);
+}
+
+void FTelekineticPropGrid::Add(ATelekineticActor* Prop)
+{
+	if (PropCells.Contains(Prop))
+	{
+		Update(Prop);
+		return;
+	}
+	const FBoxSphereBounds Bounds = GetPropBounds(Prop);
+	MaxBoundsRadius = FMath::Max(MaxBoundsRadius, Bounds.SphereRadius);
+	FPropEntry& Entry = PropCells.Add(Prop);
+	Entry.Cell = GetCell(Bounds.Origin);
+	Entry.BoundsRadius = Bounds.SphereRadius;
+	AddToCell(Prop, Entry.Cell);
+}
+
+void FTelekineticPropGrid::Remove(ATelekineticActor* Prop)
+{
+	FPropEntry Entry;
+	if (PropCells.RemoveAndCopyValue(Prop, Entry))
+	{
+		RemoveFromCell(Prop, Entry.Cell);
+		if (Entry.BoundsRadius >= MaxBoundsRadius)
+		{
+			RecalculateMaxBoundsRadius();
+		}
+	}
+}
+
+void FTelekineticPropGrid::Update(ATelekineticActor* Prop)
+{
+	FPropEntry* Entry = PropCells.Find(Prop);
+	if (Entry == nullptr)
+	{
+		return;
+	}
+	const FBoxSphereBounds Bounds = GetPropBounds(Prop);
+	const bool bWasLargest = Entry->BoundsRadius >= MaxBoundsRadius;
+	const bool bShrank = Bounds.SphereRadius < Entry->BoundsRadius;
+	Entry->BoundsRadius = Bounds.SphereRadius;
+	if (bWasLargest && bShrank)
+	{
+		RecalculateMaxBoundsRadius();
+	}
+	else
+	{
+		MaxBoundsRadius = FMath::Max(MaxBoundsRadius, Bounds.SphereRadius);
+	}
+	const FIntVector NewCell = GetCell(Bounds.Origin);
+	if (NewCell == Entry->Cell)
+	{
+		return;
+	}
+	RemoveFromCell(Prop, Entry->Cell);
+	AddToCell(Prop, NewCell);
+	Entry->Cell = NewCell;
+}
+
+void FTelekineticPropGrid::Reset()
+{
+	Cells.Empty();
+	PropCells.Empty();
+	MaxBoundsRadius = 0.f;
+}
+
+int32 FTelekineticPropGrid::Num() const
+{
+	return PropCells.Num();
+}
+
+void FTelekineticPropGrid::QueryCone(const FVector& Origin, const FVector& Direction, float StartDistance, float EndDistance,
+	float Radius, float HalfAngleDegrees, TArray<FTelekineticPropCandidate>& OutCandidates) const
+{
+	OutCandidates.Reset();
+	if (PropCells.Num() == 0 || EndDistance < StartDistance)
+	{
+		return;
+	}
+	const float TanHalfAngle = FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(HalfAngleDegrees, 0.f, 89.f)));
+
+	// March along the ray a cell at a time, visiting every cell the cone (padded by our largest prop) can touch
+	VisitedCells.Reset();
+	for (float Along = StartDistance; ; Along = FMath::Min(Along + CellSize, EndDistance))
+	{
+		const float ConeRadius = Radius + (Along - StartDistance) * TanHalfAngle;
+		const FVector Extent(ConeRadius + MaxBoundsRadius + CellSize * 0.5f);
+		const FVector Center = Origin + Direction * Along;
+		const FIntVector MinCell = GetCell(Center - Extent);
+		const FIntVector MaxCell = GetCell(Center + Extent);
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+			{
+				for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+				{
+					const FIntVector Cell(X, Y, Z);
+					bool bAlreadyVisited = false;
+					VisitedCells.Add(Cell, &bAlreadyVisited);
+					if (bAlreadyVisited)
+					{
+						continue;
+					}
+					const TArray<ATelekineticActor*>* CellProps = Cells.Find(Cell);
+					if (CellProps == nullptr)
+					{
+						continue;
+					}
+					// Cone vs bounding sphere
+					for (ATelekineticActor* Prop : *CellProps)
+					{
+						const FBoxSphereBounds Bounds = GetPropBounds(Prop);
+						const FVector ToCenter = Bounds.Origin - Origin;
+						const float CenterAlong = FVector::DotProduct(ToCenter, Direction);
+						if (CenterAlong + Bounds.SphereRadius < StartDistance || CenterAlong - Bounds.SphereRadius > EndDistance)
+						{
+							continue;
+						}
+						const float ClampedAlong = FMath::Clamp(CenterAlong, StartDistance, EndDistance);
+						const float AllowedRadius = Radius + (ClampedAlong - StartDistance) * TanHalfAngle + Bounds.SphereRadius;
+						if ((ToCenter - Direction * CenterAlong).SizeSquared() > FMath::Square(AllowedRadius))
+						{
+							continue;
+						}
+						FTelekineticPropCandidate Candidate;
+						Candidate.Prop = Prop;
+						Candidate.Distance = FMath::Max(CenterAlong - Bounds.SphereRadius, StartDistance);
+						OutCandidates.Add(Candidate);
+					}
+				}
+			}
+		}
+		if (Along >= EndDistance)
+		{
+			break;
+		}
+	}
+
+	OutCandidates.Sort([](const FTelekineticPropCandidate& A, const FTelekineticPropCandidate& B)
+	{
+		return A.Distance < B.Distance;
+	});
+}
+
+FIntVector FTelekineticPropGrid::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt(Location.X / CellSize),
+		FMath::FloorToInt(Location.Y / CellSize),
+		FMath::FloorToInt(Location.Z / CellSize)
+	);
+}
+
+void FTelekineticPropGrid::AddToCell(ATelekineticActor* Prop, const FIntVector& Cell)
+{
+	Cells.FindOrAdd(Cell).Add(Prop);
+}
+
+void FTelekineticPropGrid::RemoveFromCell(ATelekineticActor* Prop, const FIntVector& Cell)
+{
+	if (TArray<ATelekineticActor*>* CellProps = Cells.Find(Cell))
+	{
+		CellProps->RemoveSingleSwap(Prop, false);
+		if (CellProps->Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+	}
+}
+
+void FTelekineticPropGrid::RecalculateMaxBoundsRadius()
+{
+	MaxBoundsRadius = 0.f;
+	for (const TPair<ATelekineticActor*, FPropEntry>& PropCell : PropCells)
+	{
+		MaxBoundsRadius = FMath::Max(MaxBoundsRadius, PropCell.Value.BoundsRadius);
+	}
+}
+
+FBoxSphereBounds FTelekineticPropGrid::GetPropBounds(const ATelekineticActor* Prop)
+{
+	return Prop->GetMesh()->Bounds;
+}
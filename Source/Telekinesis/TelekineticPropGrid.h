@@ -0,0 +1,59 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** A telekinetic prop found by FTelekineticPropGrid::QueryCone */
+struct FTelekineticPropCandidate
+{
+	class ATelekineticActor* Prop = nullptr;
+	/** Distance along the query direction where the prop's bounds start */
+	float Distance = 0.f;
+};
+
+/**
+ * Uniform hash grid of every ATelekineticActor in the world, bucketed by bounds center.
+ * Props are moved between cells as they move, so target acquisition doesn't have to query the physics scene.
+ */
+class TELEKINESIS_API FTelekineticPropGrid
+{
+public:
+	explicit FTelekineticPropGrid(float InCellSize = 500.f);
+
+	void Add(ATelekineticActor* Prop);
+	void Remove(ATelekineticActor* Prop);
+	/** Move a prop to a new cell if it has left its current one */
+	void Update(ATelekineticActor* Prop);
+	void Reset();
+	int32 Num() const;
+
+	/**
+	 * Find props whose bounds touch a cone along a ray, sorted closest first.
+	 * The cone has Radius at StartDistance and widens by HalfAngleDegrees until EndDistance.
+	 */
+	void QueryCone(const FVector& Origin, const FVector& Direction, float StartDistance, float EndDistance,
+		float Radius, float HalfAngleDegrees, TArray<FTelekineticPropCandidate>& OutCandidates) const;
+
+private:
+	/** Where a prop is bucketed, and how far its bounds reached when it was */
+	struct FPropEntry
+	{
+		FIntVector Cell;
+		float BoundsRadius = 0.f;
+	};
+
+	float CellSize;
+	/** Largest bounds radius of the props in the grid, queries are padded by it since props are bucketed by center */
+	float MaxBoundsRadius = 0.f;
+	TMap<FIntVector, TArray<ATelekineticActor*>> Cells;
+	TMap<ATelekineticActor*, FPropEntry> PropCells;
+	/** Scratch set reused between queries */
+	mutable TSet<FIntVector> VisitedCells;
+
+	FIntVector GetCell(const FVector& Location) const;
+	void AddToCell(ATelekineticActor* Prop, const FIntVector& Cell);
+	void RemoveFromCell(ATelekineticActor* Prop, const FIntVector& Cell);
+	/** Called when the largest prop leaves or shrinks, so one big prop passing through doesn't widen every query after it */
+	void RecalculateMaxBoundsRadius();
+	static FBoxSphereBounds GetPropBounds(const ATelekineticActor* Prop);
+
+};
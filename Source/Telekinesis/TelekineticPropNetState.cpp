@@ -0,0 +1,84 @@
+#include "TelekineticPropNetState.h"
+#include "Engine/NetSerialization.h"
+
+namespace TelekineticPropNetState
+{
+	// +-10km at 1/8cm
+	constexpr int32 LocationRange = 1 << 20;
+	constexpr int32 LocationBits = 24;
+	// +-164m/s at 1/2cm/s
+	constexpr int32 VelocityRange = 1 << 14;
+	constexpr int32 VelocityBits = 16;
+	// FRotator::SerializeCompressedShort, a flag plus 16 bits per axis
+	constexpr int32 RotationBits = 3 * 17;
+	constexpr int32 StateBits = 2;
+	constexpr int32 HoldSlotBits = 8;
+}
+
+int64 FTelekineticPropNetState::BitsSent = 0;
+
+bool FTelekineticPropNetState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	using namespace TelekineticPropNetState;
+
+	// Out of range values are clamped, that's fine for anything we'd ever replicate
+	SerializeFixedVector<LocationRange, LocationBits>(Location, Ar);
+	SerializeFixedVector<VelocityRange, VelocityBits>(LinearVelocity, Ar);
+	Rotation.SerializeCompressedShort(Ar);
+
+	uint8 StateValue = static_cast<uint8>(State);
+	Ar.SerializeBits(&StateValue, StateBits);
+	State = static_cast<ETelekinesisStates>(StateValue);
+
+	// Only send what the state needs
+	if (State == ETelekinesisStates::Pulled)
+	{
+		uint8 Slot = static_cast<uint8>(FMath::Clamp(HoldSlot + 1, 0, 255));
+		Ar.SerializeBits(&Slot, HoldSlotBits);
+		HoldSlot = Slot - 1;
+	}
+	else if (State == ETelekinesisStates::Pushed)
+	{
+		SerializeFixedVector<LocationRange, LocationBits>(PushDestination, Ar);
+	}
+
+	if (Ar.IsSaving())
+	{
+		BitsSent += GetMaxNumBits(State);
+	}
+	bOutSuccess = true;
+	return true;
+}
+
+bool FTelekineticPropNetState::operator==(const FTelekineticPropNetState& Other) const
+{
+	return Location == Other.Location
+		&& LinearVelocity == Other.LinearVelocity
+		&& Rotation == Other.Rotation
+		&& State == Other.State
+		&& HoldSlot == Other.HoldSlot
+		&& PushDestination == Other.PushDestination;
+}
+
+int32 FTelekineticPropNetState::GetMaxNumBits(ETelekinesisStates InState)
+{
+	using namespace TelekineticPropNetState;
+
+	int32 NumBits = 3 * LocationBits + 3 * VelocityBits + RotationBits + StateBits;
+	if (InState == ETelekinesisStates::Pulled)
+	{
+		NumBits += HoldSlotBits;
+	}
+	else if (InState == ETelekinesisStates::Pushed)
+	{
+		NumBits += 3 * LocationBits;
+	}
+	return NumBits;
+}
+
+int64 FTelekineticPropNetState::ConsumeBitsSent()
+{
+	const int64 Bits = BitsSent;
+	BitsSent = 0;
+	return Bits;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ETelekinesisStates.h"
+#include "TelekineticPropNetState.generated.h"
+
+/**
+ * Compact replicated snapshot of an ATelekineticActor, replaces replicated movement.
+ * Everything is quantized to a fixed number of bits, so the size of an update only depends on the state.
+ */
+USTRUCT()
+struct TELEKINESIS_API FTelekineticPropNetState
+{
+	GENERATED_BODY()
+
+	FVector Location = FVector::ZeroVector;
+	FVector LinearVelocity = FVector::ZeroVector;
+	FRotator Rotation = FRotator::ZeroRotator;
+	ETelekinesisStates State = ETelekinesisStates::Default;
+	/** Only sent while Pulled */
+	int32 HoldSlot = INDEX_NONE;
+	/** Only sent while Pushed */
+	FVector PushDestination = FVector::ZeroVector;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+	bool operator==(const FTelekineticPropNetState& Other) const;
+
+	/** Most bits a single update in this state can take */
+	static int32 GetMaxNumBits(ETelekinesisStates InState);
+	/** Bits written by every prop since the last call, only the server writes any */
+	static int64 ConsumeBitsSent();
+
+private:
+	static int64 BitsSent;
+
+};
+
+template<>
+struct TStructOpsTypeTraits<FTelekineticPropNetState> : public TStructOpsTypeTraitsBase2<FTelekineticPropNetState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true,
+	};
+};
@@ -0,0 +1,93 @@
+#include "TelekineticPropTargetProcessor.h"
+#include "TelekineticPropEntitySubsystem.h"
+#include "TelekineticPropFragments.h"
+#include "MassCommonFragments.h"
+#include "MassEntitySubsystem.h"
+#include "Engine/World.h"
+#include "Misc/ScopeLock.h"
+
+UTelekineticPropTargetProcessor::UTelekineticPropTargetProcessor()
+{
+	bAutoRegisterWithProcessingPhases = true;
+	// Characters post their sweeps during TG_PrePhysics, they're all in by the time we run
+	ProcessingPhase = EMassProcessingPhase::PostPhysics;
+	// Prop entities only exist in standalone games, see UTelekineticPropEntitySubsystem
+	ExecutionFlags = (int32)EProcessorExecutionFlags::Standalone;
+}
+
+void UTelekineticPropTargetProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FDataFragment_Transform>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FTelekineticPropMassFragment>(EMassFragmentAccess::ReadOnly);
+}
+
+void UTelekineticPropTargetProcessor::Execute(UMassEntitySubsystem& EntitySubsystem, FMassExecutionContext& Context)
+{
+	UTelekineticPropEntitySubsystem* PropSubsystem = UWorld::GetSubsystem<UTelekineticPropEntitySubsystem>(EntitySubsystem.GetWorld());
+	if (PropSubsystem == nullptr || PropSubsystem->Queries.Num() == 0)
+	{
+		return;
+	}
+	TArray<FTelekineticPropEntityQuery>& Queries = PropSubsystem->Queries;
+	for (FTelekineticPropEntityQuery& Query : Queries)
+	{
+		Query.Entity = FMassEntityHandle();
+		Query.Distance = TNumericLimits<float>::Max();
+	}
+
+	// Sphere sweep against bounding spheres, the same shape the character sweeps actor props with.
+	// Chunks run in parallel, each finds its own closest entities and merges them under the lock once
+	FCriticalSection ResultsLock;
+	EntityQuery.ParallelForEachEntityChunk(EntitySubsystem, Context, [&Queries, &ResultsLock](FMassExecutionContext& Context)
+	{
+		TArray<FTelekineticPropEntityQuery, TInlineAllocator<4>> ChunkResults;
+		ChunkResults.Init(FTelekineticPropEntityQuery(), Queries.Num());
+		for (FTelekineticPropEntityQuery& ChunkResult : ChunkResults)
+		{
+			ChunkResult.Distance = TNumericLimits<float>::Max();
+		}
+
+		const TConstArrayView<FDataFragment_Transform> Transforms = Context.GetFragmentView<FDataFragment_Transform>();
+		const TConstArrayView<FTelekineticPropMassFragment> MassFragments = Context.GetFragmentView<FTelekineticPropMassFragment>();
+		const int32 NumEntities = Context.GetNumEntities();
+		for (int32 Index = 0; Index < NumEntities; ++Index)
+		{
+			const FVector Center = Transforms[Index].GetTransform().GetLocation();
+			const float BoundsRadius = MassFragments[Index].BoundsRadius;
+			for (int32 QueryIndex = 0; QueryIndex < Queries.Num(); ++QueryIndex)
+			{
+				const FTelekineticPropEntityQuery& Query = Queries[QueryIndex];
+				const FVector ToCenter = Center - Query.Start;
+				const float Along = FVector::DotProduct(ToCenter, Query.Direction);
+				if (Along < -BoundsRadius || Along > Query.Length + BoundsRadius)
+				{
+					continue;
+				}
+				if ((ToCenter - Query.Direction * Along).SizeSquared() > FMath::Square(Query.Radius + BoundsRadius))
+				{
+					continue;
+				}
+				const float Distance = FMath::Max(Along - BoundsRadius, 0.f);
+				if (Distance < ChunkResults[QueryIndex].Distance)
+				{
+					ChunkResults[QueryIndex].Distance = Distance;
+					ChunkResults[QueryIndex].Entity = Context.GetEntity(Index);
+				}
+			}
+		}
+
+		FScopeLock Lock(&ResultsLock);
+		for (int32 QueryIndex = 0; QueryIndex < Queries.Num(); ++QueryIndex)
+		{
+			const FTelekineticPropEntityQuery& ChunkResult = ChunkResults[QueryIndex];
+			FTelekineticPropEntityQuery& Query = Queries[QueryIndex];
+			// Break ties on the entity, so the winner doesn't depend on which chunk finished first
+			if (ChunkResult.Entity.IsSet() && (ChunkResult.Distance < Query.Distance
+				|| (ChunkResult.Distance == Query.Distance && ChunkResult.Entity.Index < Query.Entity.Index)))
+			{
+				Query.Distance = ChunkResult.Distance;
+				Query.Entity = ChunkResult.Entity;
+			}
+		}
+	});
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"
+#include "TelekineticPropTargetProcessor.generated.h"
+
+/**
+ * Finds the closest idle prop entity in each aim cone posted to UTelekineticPropEntitySubsystem.
+ * Runs off the game thread with the other Mass processors and spreads the entity chunks over worker threads,
+ * the subsystem picks the results up at the end of the frame.
+ */
+UCLASS()
+class TELEKINESIS_API UTelekineticPropTargetProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	UTelekineticPropTargetProcessor();
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(UMassEntitySubsystem& EntitySubsystem, FMassExecutionContext& Context) override;
+
+private:
+	FMassEntityQuery EntityQuery;
+
+};
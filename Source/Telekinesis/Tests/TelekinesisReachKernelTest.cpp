@@ -0,0 +1,123 @@
+#include "TelekinesisReachKernel.h"
+#include "Kismet/KismetMathLibrary.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTelekinesisReachKernelTest, "Telekinesis.ReachKernel.MatchesKismet",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+namespace TelekinesisReachKernelTest
+{
+	/** ATelekineticActor::GetReachImpulse before the kernel replaced it */
+	FVector GetKismetImpulse(const FVector& From, const FVector& Target, float Scale, bool bConstantSpeed)
+	{
+		FVector MoveDirection = Target - From;
+		if (bConstantSpeed)
+		{
+			MoveDirection = MoveDirection.GetSafeNormal();
+		}
+		MoveDirection = UKismetMathLibrary::ClampVectorSize(MoveDirection, 0.f, 1000.f);
+		return MoveDirection * Scale;
+	}
+}
+
+/**
+ * Checks FTelekinesisReachKernel against the Kismet calls it replaced in the Lift and Reach paths, and its damping against its limits,
+ * over ordinary values and the edge cases: zero length ranges, values past either end, and no distance left to move.
+ */
+bool FTelekinesisReachKernelTest::RunTest(const FString& Parameters)
+{
+	using namespace TelekinesisReachKernelTest;
+
+	// Impulses, within the clamp, past it, and with nothing left to move
+	const FVector From(100.f, -200.f, 50.f);
+	const FVector Offsets[] = {
+		FVector::ZeroVector,
+		FVector(KINDA_SMALL_NUMBER, 0.f, 0.f),
+		FVector(10.f, 0.f, 0.f),
+		FVector(-300.f, 400.f, 0.f),
+		FVector(600.f, 800.f, 0.f),
+		FVector(999.f, 0.f, 0.f),
+		FVector(0.f, 0.f, 1000.f),
+		FVector(1001.f, 0.f, 0.f),
+		FVector(-5000.f, 2500.f, -12000.f)
+	};
+	const float Scales[] = { 0.f, 0.02f, 1.f, 3.5f };
+	for (const FVector& Offset : Offsets)
+	{
+		for (const float Scale : Scales)
+		{
+			for (const bool bConstantSpeed : { false, true })
+			{
+				const FVector Expected = GetKismetImpulse(From, From + Offset, Scale, bConstantSpeed);
+				const FVector Actual = FTelekinesisReachKernel::GetImpulse(From, From + Offset, Scale, bConstantSpeed);
+				// Relative, the kernel clamps with an approximate inverse square root
+				const float Tolerance = FMath::Max(Expected.Size() * 1.e-4f, KINDA_SMALL_NUMBER);
+				TestTrue(FString::Printf(TEXT("GetImpulse offset %s scale %g constant speed %d: expected %s, got %s"), *Offset.ToString(), Scale,
+					bConstantSpeed, *Expected.ToString(), *Actual.ToString()), Actual.Equals(Expected, Tolerance));
+			}
+		}
+	}
+
+	// Lift alpha, before, during and after the lift, and for a lift that takes no time at all
+	const float StartTimes[] = { 0.f, 2.5f, 1000.f };
+	const float Durations[] = { 0.f, 0.25f, 1.f, 10.f };
+	const float TimeOffsets[] = { -1.f, 0.f, 0.1f, 0.5f, 0.999f, 1.f, 1.5f, 100.f };
+	for (const float StartTime : StartTimes)
+	{
+		for (const float Duration : Durations)
+		{
+			const float EndTime = StartTime + Duration;
+			for (const float TimeOffset : TimeOffsets)
+			{
+				// Offsets are fractions of the lift, or seconds when it takes no time
+				const float Time = StartTime + TimeOffset * (Duration > 0.f ? Duration : 1.f);
+				const float Expected = UKismetMathLibrary::MapRangeClamped(Time, StartTime, EndTime, 0.f, 1.f);
+				const float Actual = FTelekinesisReachKernel::GetLiftAlpha(Time, StartTime, EndTime);
+				TestEqual(FString::Printf(TEXT("GetLiftAlpha at %g from %g to %g"), Time, StartTime, EndTime), Actual, Expected, 1.e-5f);
+			}
+		}
+	}
+
+	// Lift height, the same lerp UKismetMathLibrary::Lerp does
+	const float Alphas[] = { 0.f, 0.3f, 1.f };
+	for (const float Alpha : Alphas)
+	{
+		TestEqual(FString::Printf(TEXT("GetLiftHeight at %g"), Alpha), FTelekinesisReachKernel::GetLiftHeight(120.f, 270.f, Alpha),
+			UKismetMathLibrary::Lerp(120.f, 270.f, Alpha), KINDA_SMALL_NUMBER);
+	}
+
+	// Damping has no Kismet counterpart, so check its limits, and that more damping or a longer step never damps less.
+	// Both lists are in increasing order
+	const float Dampings[] = { 0.f, 0.01f, 1.f, 20.f, 1000.f };
+	const float DeltaTimes[] = { 0.f, 1.f / 120.f, 1.f / 60.f, 1.f / 30.f, 1.f };
+	for (int32 DampingIndex = 0; DampingIndex < UE_ARRAY_COUNT(Dampings); ++DampingIndex)
+	{
+		for (int32 DeltaTimeIndex = 0; DeltaTimeIndex < UE_ARRAY_COUNT(DeltaTimes); ++DeltaTimeIndex)
+		{
+			const float Damping = Dampings[DampingIndex];
+			const float DeltaTime = DeltaTimes[DeltaTimeIndex];
+			const float Actual = FTelekinesisReachKernel::GetDampingScale(Damping, DeltaTime);
+			const FString What = FString::Printf(TEXT("GetDampingScale damping %g over %g"), Damping, DeltaTime);
+			TestTrue(What + TEXT(" is in (0, 1]"), Actual > 0.f && Actual <= 1.f);
+			if (Damping == 0.f || DeltaTime == 0.f)
+			{
+				TestEqual(What + TEXT(" leaves velocity alone"), Actual, 1.f);
+			}
+			if (DampingIndex > 0)
+			{
+				TestTrue(What + TEXT(" damps at least as much as less damping"),
+					Actual <= FTelekinesisReachKernel::GetDampingScale(Dampings[DampingIndex - 1], DeltaTime));
+			}
+			if (DeltaTimeIndex > 0)
+			{
+				TestTrue(What + TEXT(" damps at least as much as a shorter step"),
+					Actual <= FTelekinesisReachKernel::GetDampingScale(Damping, DeltaTimes[DeltaTimeIndex - 1]));
+			}
+		}
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,102 @@
+#include "TelekinesisCharacter.h"
+#include "TelekinesisWorldSubsystem.h"
+#include "TelekineticActor.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTelekinesisTargetAcquisitionTest, "Telekinesis.TargetAcquisition.PropGridMatchesTrace",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/**
+ * Fills a world with a dense, randomly rotated block of props, then aims through and around it and checks that
+ * ATelekinesisCharacter::FindTargetInPropGrid picks the same prop as the sphere trace it replaces, at the same distance.
+ */
+bool FTelekinesisTargetAcquisitionTest::RunTest(const FString& Parameters)
+{
+	UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!TestNotNull(TEXT("Cube mesh"), Cube))
+	{
+		return false;
+	}
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	UTelekinesisWorldSubsystem* TelekinesisSubsystem = World->GetSubsystem<UTelekinesisWorldSubsystem>();
+	ATelekinesisCharacter* Character = World->SpawnActor<ATelekinesisCharacter>(FVector(-2000.f, 0.f, 0.f), FRotator::ZeroRotator);
+	if (!TestNotNull(TEXT("Telekinesis subsystem"), TelekinesisSubsystem) || !TestNotNull(TEXT("Character"), Character))
+	{
+		World->DestroyWorld(false);
+		World->RemoveFromRoot();
+		return false;
+	}
+	// Compare against a trace we run now, not last frame's async one
+	Character->bAsyncTraces = false;
+
+	// Half size cubes 60 apart, closer than our detection sphere is wide, so most sweeps pass near several props
+	FRandomStream RandomStream(0x5eed);
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	const int32 GridSize = 8;
+	const float GridSpacing = 60.f;
+	for (int32 X = 0; X < GridSize; ++X)
+	{
+		for (int32 Y = 0; Y < GridSize; ++Y)
+		{
+			for (int32 Z = 0; Z < GridSize; ++Z)
+			{
+				const FVector Location = FVector(X, Y, Z) * GridSpacing;
+				ATelekineticActor* Prop = World->SpawnActor<ATelekineticActor>(Location, FRotator(RandomStream.FRandRange(0.f, 90.f),
+					RandomStream.FRandRange(0.f, 90.f), 0.f), SpawnParameters);
+				UStaticMeshComponent* Mesh = Prop->GetMesh();
+				Mesh->SetWorldScale3D(FVector(RandomStream.FRandRange(0.2f, 0.5f)));
+				Mesh->SetStaticMesh(Cube);
+				Mesh->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+				Mesh->SetCollisionObjectType(ECC_GameTraceChannel1);
+				Mesh->SetCollisionResponseToAllChannels(ECR_Block);
+				// Props register with the grid on BeginPlay, which this world never runs
+				TelekinesisSubsystem->RegisterProp(Prop);
+			}
+		}
+	}
+
+	// Aim from in front of the block at random points in and around it, so we get hits, grazes and misses
+	const float GridExtent = GridSize * GridSpacing;
+	const int32 NumRays = 500;
+	int32 NumHits = 0;
+	for (int32 Ray = 0; Ray < NumRays; ++Ray)
+	{
+		const FVector Origin(-1500.f, RandomStream.FRandRange(-200.f, GridExtent + 200.f), RandomStream.FRandRange(-200.f, GridExtent + 200.f));
+		const FVector Aim = FVector(RandomStream.FRandRange(0.f, GridExtent), RandomStream.FRandRange(-100.f, GridExtent + 100.f),
+			RandomStream.FRandRange(-100.f, GridExtent + 100.f));
+		const FVector Direction = (Aim - Origin).GetSafeNormal();
+		const FVector StartLocation = Origin + Direction * Character->DetectionRadius;
+		const FVector EndLocation = Origin + Direction * Character->TelekinesisDistance;
+
+		float GridDistance = 0.f;
+		float TraceDistance = 0.f;
+		const ATelekineticActor* GridProp = Character->FindTargetInPropGrid(StartLocation, EndLocation, GridDistance);
+		const ATelekineticActor* TraceProp = Character->FindTargetWithTrace(StartLocation, EndLocation, TraceDistance);
+		if (GridProp != TraceProp)
+		{
+			AddError(FString::Printf(TEXT("Ray %d from %s to %s: prop grid picked %s, sphere trace picked %s"), Ray, *StartLocation.ToString(),
+				*EndLocation.ToString(), *GetNameSafe(GridProp), *GetNameSafe(TraceProp)));
+			continue;
+		}
+		if (TraceProp != nullptr)
+		{
+			++NumHits;
+			TestEqual(FString::Printf(TEXT("Ray %d hit distance"), Ray), GridDistance, TraceDistance, 0.1f);
+		}
+	}
+	// Make sure the rays actually exercised the precise test
+	TestTrue(TEXT("Most rays hit a prop"), NumHits > NumRays / 2);
+
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+	return true;
+}
+
+#endif